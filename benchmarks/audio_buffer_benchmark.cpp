@@ -0,0 +1,123 @@
+#include "benchmark.h"
+#include "../include/audio_buffer.h"
+#include <string>
+
+/**
+ * Reference scalar implementations, equivalent to the
+ * original AudioBuffer loops.
+ */
+namespace Reference {
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void applyGain(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer, float gain) {
+        for (size_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+            float *channel = buffer.getWritePointer(channelNumber);
+            for (size_t i = 0; i < BUFFER_LEN; i++) {
+                channel[i] *= gain;
+            }
+        }
+    }
+
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void add(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+             const AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer2) {
+        for (size_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+            float *channel1 = buffer1.getWritePointer(channelNumber);
+            const float *channel2 = buffer2.getReadPointer(channelNumber);
+            for (size_t i = 0; i < BUFFER_LEN; i++) {
+                channel1[i] += channel2[i];
+            }
+        }
+    }
+
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void multiply(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+                  const AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer2) {
+        for (size_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+            float *channel1 = buffer1.getWritePointer(channelNumber);
+            const float *channel2 = buffer2.getReadPointer(channelNumber);
+            for (size_t i = 0; i < BUFFER_LEN; i++) {
+                channel1[i] *= channel2[i];
+            }
+        }
+    }
+
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void multiplyAdd(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+                     const AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer2,
+                     const AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer3) {
+        // the unfused version needs a temporary buffer
+        static AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> temporary;
+        temporary.copyFrom(buffer2);
+        multiply(temporary, buffer3);
+        add(buffer1, temporary);
+    }
+
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void addWithGain(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+                     const AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &buffer2, float gain) {
+        static AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> temporary;
+        temporary.copyFrom(buffer2);
+        applyGain(temporary, gain);
+        add(buffer1, temporary);
+    }
+}
+
+template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+void runCase() {
+    static AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> buffer1;
+    static AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> buffer2;
+    static AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> buffer3;
+    for (size_t channel = 0; channel < CHANNEL_NUM; channel++) {
+        for (size_t i = 0; i < BUFFER_LEN; i++) {
+            buffer2.getWritePointer(channel)[i] = 1.0f + 1e-6f * i;
+            buffer3.getWritePointer(channel)[i] = 1.0f - 1e-6f * i;
+        }
+    }
+
+    const size_t iterations = (1u << 22) / (CHANNEL_NUM * BUFFER_LEN);
+    const std::string suffix = " " + std::to_string(CHANNEL_NUM) + "x" + std::to_string(BUFFER_LEN);
+    double baseline, candidate;
+
+    baseline = Benchmark::measure([&] { Reference::applyGain(buffer1, 0.999f); }, iterations);
+    candidate = Benchmark::measure([&] { buffer1.applyGain(0.999f); }, iterations);
+    Benchmark::report(("applyGain" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] { Reference::add(buffer1, buffer2); }, iterations);
+    candidate = Benchmark::measure([&] { buffer1.add(buffer2); }, iterations);
+    Benchmark::report(("add" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] { Reference::multiply(buffer1, buffer2); }, iterations);
+    candidate = Benchmark::measure([&] { buffer1.multiply(buffer3); }, iterations);
+    Benchmark::report(("multiply" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] { Reference::multiplyAdd(buffer1, buffer2, buffer3); }, iterations);
+    candidate = Benchmark::measure([&] { buffer1.multiplyAdd(buffer2, buffer3); }, iterations);
+    Benchmark::report(("multiplyAdd" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] { Reference::addWithGain(buffer1, buffer2, 0.5f); }, iterations);
+    candidate = Benchmark::measure([&] { buffer1.addWithGain(buffer2, 0.5f); }, iterations);
+    Benchmark::report(("addWithGain" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] {
+        buffer1.copyFrom(buffer2);
+        buffer1.multiply(buffer3);
+        buffer1.add(buffer2);
+        buffer1.applyGain(0.5f);
+    }, iterations);
+    candidate = Benchmark::measure([&] { buffer1 = (buffer2 * buffer3 + buffer2) * 0.5f; }, iterations);
+    Benchmark::report(("chain/expression" + suffix).c_str(), baseline, candidate);
+
+    Benchmark::doNotOptimize(buffer1);
+}
+
+int main() {
+    std::printf("AudioSimd backend: %s\n", AudioSimd::backendName);
+    Benchmark::header("scalar", "AudioBuffer");
+    runCase<1, 64>();
+    runCase<1, 256>();
+    runCase<2, 64>();
+    runCase<2, 256>();
+    runCase<2, 1024>();
+    runCase<8, 256>();
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "benchmark.h"
+#include "../include/audio_graph.h"
+#include "../include/audio_graph_scheduler.h"
+#include "../include/audio_processor.h"
+#include <memory>
+#include <string>
+#include <thread>
+
+class EmptyProcessor : public AudioProcessor {
+public:
+    explicit EmptyProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+    void process() override {};
+};
+
+/**
+ * Cascade of one pole lowpass filters, a serial load that does not vectorize.
+ */
+class FilterModule : public AudioModule<2> {
+public:
+    explicit FilterModule(AudioProcessor &audioProcessor) : AudioModule<2>(audioProcessor) {
+        for (float &s : state) s = 0.0f;
+    };
+
+    void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+        for (size_t c = 0; c < 2; c++) {
+            float *samples = buffer.getWritePointer(c);
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                float x = samples[i] + 0.001f;
+                for (size_t stage = 0; stage < STAGES; stage++) {
+                    state[c * STAGES + stage] += 0.1f * (x - state[c * STAGES + stage]);
+                    x = state[c * STAGES + stage];
+                }
+                samples[i] = x;
+            }
+        }
+    };
+
+private:
+    static constexpr size_t STAGES = 8;
+    float state[2 * STAGES];
+};
+
+int main() {
+    // 8 independent branches of 4 filters, mixed together
+    const size_t branchNumber = 8;
+    const size_t branchLength = 4;
+    typedef AudioGraph<2, 64> Graph;
+
+    AudioDriver driver;
+    EmptyProcessor processor(driver);
+    static std::unique_ptr<FilterModule> modules[branchNumber * branchLength];
+    static std::unique_ptr<FilterModule> mixer;
+    mixer.reset(new FilterModule(processor));
+    static Graph sequential;
+    static Graph parallel;
+    for (Graph *graph : {&sequential, &parallel}) {
+        const auto mix = graph->add(*mixer);
+        for (size_t b = 0; b < branchNumber; b++) {
+            auto previous = Graph::invalidId;
+            for (size_t m = 0; m < branchLength; m++) {
+                if (graph == &sequential) modules[b * branchLength + m].reset(new FilterModule(processor));
+                const auto node = graph->add(*modules[b * branchLength + m]);
+                if (previous != Graph::invalidId) graph->connect(previous, node);
+                previous = node;
+            }
+            graph->connect(previous, mix);
+        }
+        graph->setOutput(mix);
+    }
+    sequential.build();
+    parallel.build(true);
+
+    static AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> output;
+    const size_t iterations = 200;
+    const double baseline = Benchmark::measure([&] { sequential.process(output); }, iterations);
+
+    const size_t cores = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+    std::printf("%zu nodes, %zu cores\n", sequential.size(), cores);
+    Benchmark::header("sequential", "scheduler");
+    for (size_t threads = 1; threads <= cores && threads <= 16; threads++) {
+        AudioGraphScheduler<Graph, 16> scheduler(parallel, threads);
+        const double candidate = Benchmark::measure([&] { scheduler.process(output); }, iterations);
+        const std::string label = std::to_string(threads) + " threads";
+        Benchmark::report(label.c_str(), baseline, candidate);
+    }
+
+    Benchmark::doNotOptimize(output);
+    return 0;
+}
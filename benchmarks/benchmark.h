@@ -0,0 +1,87 @@
+
+#ifndef MIOSIX_AUDIO_BENCHMARK_H
+#define MIOSIX_AUDIO_BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+
+/**
+ * Minimal helpers shared by the microbenchmarks of the framework.
+ */
+namespace Benchmark {
+
+    /**
+     * Prevents the compiler from optimizing away a value
+     * computed inside a benchmark.
+     *
+     * @param value value to keep alive
+     */
+    template<typename T>
+    inline void doNotOptimize(T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile T sink;
+        sink = value;
+#endif
+    }
+
+    /**
+     * Forces the compiler to assume that all the memory
+     * may have been read or written.
+     */
+    inline void clobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#endif
+    }
+
+    /**
+     * Measures the execution time of a function, returning the best
+     * average over a certain number of repetitions.
+     *
+     * @param function callable to measure
+     * @param iterations number of calls of each repetition
+     * @param repetitions number of repetitions
+     * @return nanoseconds per call
+     */
+    template<typename F>
+    double measure(F &&function, size_t iterations, size_t repetitions = 5) {
+        double best = 0;
+        for (size_t r = 0; r < repetitions; r++) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                function();
+                clobberMemory();
+            }
+            auto end = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        return best;
+    }
+
+    /**
+     * Prints a line comparing a baseline against a candidate implementation.
+     *
+     * @param name name of the test case
+     * @param baseline nanoseconds per call of the baseline
+     * @param candidate nanoseconds per call of the candidate
+     */
+    inline void report(const char *name, double baseline, double candidate) {
+        std::printf("%-40s %12.1f ns %12.1f ns %8.2fx\n", name, baseline, candidate, baseline / candidate);
+    }
+
+    /**
+     * Prints the header of the table printed by report().
+     *
+     * @param baselineName label of the baseline column
+     * @param candidateName label of the candidate column
+     */
+    inline void header(const char *baselineName, const char *candidateName) {
+        std::printf("%-40s %15s %15s %9s\n", "case", baselineName, candidateName, "speedup");
+    }
+}
+
+#endif //MIOSIX_AUDIO_BENCHMARK_H
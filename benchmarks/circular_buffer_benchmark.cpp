@@ -0,0 +1,62 @@
+#include "benchmark.h"
+#include "../include/circular_buffer.h"
+#include <string>
+
+/**
+ * Compares the Generic and PowerOfTwo indexing policies
+ * on a CircularBuffer of the same size.
+ */
+template<size_t BufferSize>
+void runCase() {
+    typedef CircularBuffer<float, BufferSize, CircularBufferType::Overwrite,
+            CircularBufferIndexing::Generic<BufferSize>> GenericBuffer;
+    typedef CircularBuffer<float, BufferSize, CircularBufferType::Overwrite,
+            CircularBufferIndexing::PowerOfTwo<BufferSize>> PowerOfTwoBuffer;
+    static GenericBuffer generic;
+    static PowerOfTwoBuffer powerOfTwo;
+    static float block[256];
+
+    const size_t iterations = 1000;
+    const std::string suffix = " " + std::to_string(BufferSize);
+    double baseline, candidate;
+
+    auto pushPop = [](auto &buffer) {
+        for (size_t i = 0; i < BufferSize; i++) {
+            buffer.push(static_cast<float>(i));
+            buffer.push(static_cast<float>(i));
+            buffer.pop();
+        }
+    };
+    baseline = Benchmark::measure([&] { pushPop(generic); }, iterations);
+    candidate = Benchmark::measure([&] { pushPop(powerOfTwo); }, iterations);
+    Benchmark::report(("push/pop" + suffix).c_str(), baseline, candidate);
+
+    auto iterate = [](auto &buffer) {
+        float sum = 0;
+        for (auto item : buffer) {
+            sum += item;
+        }
+        Benchmark::doNotOptimize(sum);
+    };
+    baseline = Benchmark::measure([&] { iterate(generic); }, iterations);
+    candidate = Benchmark::measure([&] { iterate(powerOfTwo); }, iterations);
+    Benchmark::report(("iterate" + suffix).c_str(), baseline, candidate);
+
+    auto blocks = [](auto &buffer) {
+        for (size_t i = 0; i < BufferSize / 64; i++) {
+            buffer.write(block, 256);
+            buffer.read(block, 200);
+        }
+    };
+    baseline = Benchmark::measure([&] { blocks(generic); }, iterations);
+    candidate = Benchmark::measure([&] { blocks(powerOfTwo); }, iterations);
+    Benchmark::report(("write/read blocks" + suffix).c_str(), baseline, candidate);
+}
+
+int main() {
+    Benchmark::header("Generic", "PowerOfTwo");
+    runCase<256>();
+    runCase<1024>();
+    runCase<4096>();
+    return 0;
+}
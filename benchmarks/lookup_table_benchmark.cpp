@@ -0,0 +1,44 @@
+#include "benchmark.h"
+#include "../include/audio_math.h"
+#include <cmath>
+#include <string>
+
+template<size_t BLOCK_LEN>
+void runCase(const AudioMath::LookupTable<4096> &lut, const char *name) {
+    static float input[BLOCK_LEN];
+    static float output[BLOCK_LEN];
+    for (size_t i = 0; i < BLOCK_LEN; i++) {
+        // sweeping inside and outside the range of the tables
+        input[i] = -4.0f + 8.0f * static_cast<float>(i) / BLOCK_LEN;
+    }
+
+    const size_t iterations = (1u << 22) / BLOCK_LEN;
+    const std::string label = std::string(name) + " " + std::to_string(BLOCK_LEN);
+
+    double baseline = Benchmark::measure([&] {
+        for (size_t i = 0; i < BLOCK_LEN; i++) {
+            output[i] = lut(input[i]);
+        }
+    }, iterations);
+    double candidate = Benchmark::measure([&] { lut.process(input, output, BLOCK_LEN); }, iterations);
+    Benchmark::report(label.c_str(), baseline, candidate);
+
+    Benchmark::doNotOptimize(output);
+}
+
+int main() {
+    auto f = [](float x) -> float { return std::sin(x); };
+    static AudioMath::LookupTable<4096> zeroed(f, -M_PI, M_PI, AudioMath::LookupTableEdges::ZEROED);
+    static AudioMath::LookupTable<4096> extended(f, -M_PI, M_PI, AudioMath::LookupTableEdges::EXTENDED);
+    static AudioMath::LookupTable<4096> periodic(f, -1.0f, 1.0f, AudioMath::LookupTableEdges::PERIODIC);
+
+    std::printf("AudioSimd backend: %s\n", AudioSimd::backendName);
+    Benchmark::header("operator()", "process");
+    runCase<64>(zeroed, "ZEROED");
+    runCase<256>(zeroed, "ZEROED");
+    runCase<64>(extended, "EXTENDED");
+    runCase<256>(extended, "EXTENDED");
+    runCase<64>(periodic, "PERIODIC");
+    runCase<256>(periodic, "PERIODIC");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "../include/offline_audio_driver.h"
+#include "../include/audio_processor.h"
+#include "../include/audio_math.h"
+#include "../include/audio_parameter.h"
+#include "../include/delay_line.h"
+#include <cstdio>
+
+/**
+ * Small synth voice: a table oscillator with a smoothed gain,
+ * followed by a modulated delay on the right channel.
+ */
+class VoiceProcessor : public AudioProcessor {
+public:
+    VoiceProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver),
+                                               sine(AudioMath::LookupTableGenerator::Sine(), 0.0f, 2.0f * M_PI,
+                                                    AudioMath::LookupTableEdges::PERIODIC),
+                                               phase{0},
+                                               increment(AudioMath::FixedPointPhase::increment(220.0f, AUDIO_DRIVER_SAMPLE_RATE)),
+                                               gain(0.0f),
+                                               blockCount(0) {
+        gain.setTransitionSamples(AUDIO_DRIVER_SAMPLE_RATE / 10);
+    };
+
+    void process() override {
+        auto &buffer = getBuffer();
+        float *left = buffer.getWritePointer(0);
+        float *right = buffer.getWritePointer(1);
+
+        for (size_t i = 0; i < AUDIO_DRIVER_BUFFER_SIZE; i++) {
+            left[i] = sine(phase);
+            phase += increment;
+        }
+        AudioSimd::copy(right, left, AUDIO_DRIVER_BUFFER_SIZE);
+
+        float delays[AUDIO_DRIVER_BUFFER_SIZE];
+        for (size_t i = 0; i < AUDIO_DRIVER_BUFFER_SIZE; i++) {
+            delays[i] = 300.0f + 50.0f * left[i];
+        }
+        delay.process(buffer, 1, delays);
+
+        // a new note every second
+        if (blockCount++ % (AUDIO_DRIVER_SAMPLE_RATE / AUDIO_DRIVER_BUFFER_SIZE) == 0) {
+            gain.setValue(gain.getValue() > 0.25f ? 0.1f : 0.5f);
+        }
+        gain.applyRamp(buffer);
+    }
+
+private:
+    AudioMath::LookupTable<1024> sine;
+    AudioMath::FixedPointPhase phase;
+    uint32_t increment;
+    AudioParameter<float> gain;
+    DelayLine<float, 512, DelayLineInterpolation::Linear> delay;
+    size_t blockCount;
+};
+
+int main(int argc, char **argv) {
+    // rendering 60 seconds, to the file passed as argument if any
+    const size_t blocks = 60 * AUDIO_DRIVER_SAMPLE_RATE / AUDIO_DRIVER_BUFFER_SIZE;
+    OfflineAudioDriver driver(argc > 1 ? argv[1] : nullptr, blocks);
+    VoiceProcessor processor(driver);
+    if (!driver.init()) {
+        std::printf("cannot open the output file\n");
+        return 1;
+    }
+    driver.setAudioProcessable(processor);
+    if (!driver.start()) {
+        std::printf("error while rendering\n");
+        return 1;
+    }
+
+    std::printf("rendered %.1f s in %.3f s, realtime factor %.1f\n",
+                driver.getRenderedSeconds(), driver.getElapsedSeconds(), driver.getRealtimeFactor());
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "benchmark.h"
+#include "../include/audio_math.h"
+#include "../include/audio_pcm.h"
+#include <cmath>
+#include <string>
+
+template<size_t BLOCK_LEN>
+void runCase() {
+    static float left[BLOCK_LEN];
+    static float right[BLOCK_LEN];
+    static int16_t output16[2 * BLOCK_LEN];
+    static int32_t output32[2 * BLOCK_LEN];
+    for (size_t i = 0; i < BLOCK_LEN; i++) {
+        left[i] = 1.2f * std::sin(0.01f * i);
+        right[i] = 1.2f * std::cos(0.01f * i);
+    }
+
+    const size_t iterations = (1u << 22) / BLOCK_LEN;
+    const std::string suffix = " " + std::to_string(BLOCK_LEN);
+
+    // naive loop: clip, scale, truncate and interleave one sample at a time
+    double baseline = Benchmark::measure([&] {
+        for (size_t i = 0; i < BLOCK_LEN; i++) {
+            output16[2 * i] = static_cast<int16_t>(AudioMath::clip(left[i], -1.0f, 1.0f) * 32767.0f);
+            output16[2 * i + 1] = static_cast<int16_t>(AudioMath::clip(right[i], -1.0f, 1.0f) * 32767.0f);
+        }
+    }, iterations);
+    double candidate = Benchmark::measure([&] { AudioPcm::interleave(output16, left, right, BLOCK_LEN); },
+                                          iterations);
+    Benchmark::report(("int16" + suffix).c_str(), baseline, candidate);
+
+    baseline = Benchmark::measure([&] {
+        for (size_t i = 0; i < BLOCK_LEN; i++) {
+            output32[2 * i] = static_cast<int32_t>(AudioMath::clip(left[i], -1.0f, 1.0f) * 8388607.0f);
+            output32[2 * i + 1] = static_cast<int32_t>(AudioMath::clip(right[i], -1.0f, 1.0f) * 8388607.0f);
+        }
+    }, iterations);
+    candidate = Benchmark::measure([&] { AudioPcm::interleave(output32, left, right, BLOCK_LEN, 24); }, iterations);
+    Benchmark::report(("int24" + suffix).c_str(), baseline, candidate);
+
+    // cost of the dither, against the vectorized conversion
+    PcmConverter converter(PcmDither::NONE);
+    PcmConverter ditheredConverter(PcmDither::NOISE_SHAPED);
+    baseline = Benchmark::measure([&] { converter.convert(output16, left, right, BLOCK_LEN); }, iterations);
+    candidate = Benchmark::measure([&] { ditheredConverter.convert(output16, left, right, BLOCK_LEN); }, iterations);
+    Benchmark::report(("noise shaped dither" + suffix).c_str(), baseline, candidate);
+
+    Benchmark::doNotOptimize(output16);
+    Benchmark::doNotOptimize(output32);
+}
+
+int main() {
+    std::printf("AudioSimd backend: %s\n", AudioSimd::backendName);
+    Benchmark::header("scalar", "AudioPcm");
+    runCase<64>();
+    runCase<256>();
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "benchmark.h"
+#include "../include/static_chain.h"
+#include "../include/audio_processor.h"
+#include <array>
+
+class EmptyProcessor : public AudioProcessor {
+public:
+    explicit EmptyProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+    void process() override {};
+};
+
+/**
+ * Gain with a constant offset.
+ */
+class GainModule final : public AudioModule<2> {
+public:
+    GainModule(AudioProcessor &audioProcessor, float gain) : AudioModule<2>(audioProcessor), gain(gain) {};
+
+    void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+        for (size_t c = 0; c < 2; c++) {
+            float *samples = buffer.getWritePointer(c);
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) samples[i] = samples[i] * gain + 0.001f;
+        }
+    };
+
+private:
+    float gain;
+};
+
+/**
+ * One pole lowpass filter.
+ */
+class LowpassModule final : public AudioModule<2> {
+public:
+    LowpassModule(AudioProcessor &audioProcessor, float coefficient)
+            : AudioModule<2>(audioProcessor), coefficient(coefficient), state{0.0f, 0.0f} {};
+
+    void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+        for (size_t c = 0; c < 2; c++) {
+            float *samples = buffer.getWritePointer(c);
+            float y = state[c];
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                y += coefficient * (samples[i] - y);
+                samples[i] = y;
+            }
+            state[c] = y;
+        }
+    };
+
+private:
+    float coefficient;
+    float state[2];
+};
+
+int main() {
+    AudioDriver driver;
+    EmptyProcessor processor(driver);
+    GainModule g0(processor, 0.9f), g1(processor, 1.1f), g2(processor, 0.8f), g3(processor, 1.2f),
+            g4(processor, 0.95f), g5(processor, 1.05f);
+    LowpassModule l0(processor, 0.5f), l1(processor, 0.4f), l2(processor, 0.3f), l3(processor, 0.2f);
+
+    // virtual path: a loop over the modules, as in the AudioGraph
+    std::array<AudioModule<2> *, 10> modules = {&g0, &l0, &g1, &l1, &g2, &l2, &g3, &l3, &g4, &g5};
+    // hides the dynamic types, as when the modules are built elsewhere
+    Benchmark::doNotOptimize(modules);
+
+    StaticChain<GainModule, LowpassModule, GainModule, LowpassModule, GainModule,
+            LowpassModule, GainModule, LowpassModule, GainModule, GainModule>
+            chain(g0, l0, g1, l1, g2, l2, g3, l3, g4, g5);
+
+    static AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> buffer;
+    buffer.clear();
+    const size_t iterations = 20000;
+
+    const double baseline = Benchmark::measure([&] {
+        for (AudioModule<2> *module : modules) module->process(buffer);
+        Benchmark::clobberMemory();
+    }, iterations);
+    const double candidate = Benchmark::measure([&] {
+        chain.process(buffer);
+        Benchmark::clobberMemory();
+    }, iterations);
+
+    std::printf("10 modules, %d samples\n", AUDIO_PROCESSOR_BLOCK_SIZE);
+    Benchmark::header("virtual", "StaticChain");
+    Benchmark::report("chain", baseline, candidate);
+
+    Benchmark::doNotOptimize(buffer);
+    return 0;
+}
@@ -0,0 +1,120 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_BLOCK_ADAPTER_H
+#define MIOSIX_AUDIO_AUDIO_BLOCK_ADAPTER_H
+
+#include <cstddef>
+#include "audio_buffer.h"
+#include "audio_processable.h"
+#include "audio_simd.h"
+
+/**
+ * AudioProcessable that fills an output buffer of BUFFER_LEN samples
+ * with the blocks of BLOCK_LEN samples rendered by another AudioProcessable
+ * into the block buffer.
+ *
+ * The blocks are consumed in order: a smaller block is rendered several
+ * times for each output buffer, a larger one once every few output buffers,
+ * and when the sizes do not divide evenly a block spans two output buffers.
+ * Each sample is copied once from the block buffer to the output buffer,
+ * without intermediate queues. When the sizes are equal the block buffer
+ * is the output buffer itself, see the specialization below.
+ *
+ * @tparam CHANNEL_NUM number of channels
+ * @tparam BLOCK_LEN length of the blocks rendered by the processable
+ * @tparam BUFFER_LEN length of the output buffer
+ */
+template<size_t CHANNEL_NUM, size_t BLOCK_LEN, size_t BUFFER_LEN>
+class AudioBlockAdapter : public AudioProcessable {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param outputBuffer buffer filled by each process() call
+     */
+    explicit AudioBlockAdapter(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &outputBuffer)
+            : outputBuffer(outputBuffer), blockProcessable(nullptr), blockPosition(BLOCK_LEN) {};
+
+    /**
+     * Sets the processable that renders the blocks.
+     *
+     * @param newBlockProcessable processable writing the block buffer
+     */
+    inline void setBlockProcessable(AudioProcessable &newBlockProcessable) {
+        blockProcessable = &newBlockProcessable;
+    };
+
+    /**
+     * Buffer to be written by the block processable.
+     *
+     * @return block buffer
+     */
+    inline AudioBuffer<float, CHANNEL_NUM, BLOCK_LEN> &getBlockBuffer() { return blockBuffer; };
+
+    /**
+     * Fills the output buffer, rendering new blocks when needed.
+     */
+    void process() override {
+        size_t written = 0;
+        while (written < BUFFER_LEN) {
+            if (blockPosition == BLOCK_LEN) {
+                blockProcessable->process();
+                blockPosition = 0;
+            }
+            const size_t available = BLOCK_LEN - blockPosition;
+            const size_t n = (available < BUFFER_LEN - written) ? available : BUFFER_LEN - written;
+            for (size_t channel = 0; channel < CHANNEL_NUM; channel++) {
+                AudioSimd::copy(outputBuffer.getWritePointer(channel) + written,
+                                blockBuffer.getReadPointer(channel) + blockPosition, n);
+            }
+            written += n;
+            blockPosition += n;
+        }
+    };
+
+    /**
+     * Discards the samples of the current block,
+     * the next process() starts from a new block.
+     */
+    inline void reset() { blockPosition = BLOCK_LEN; };
+
+private:
+    AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &outputBuffer;
+
+    AudioBuffer<float, CHANNEL_NUM, BLOCK_LEN> blockBuffer;
+
+    AudioProcessable *blockProcessable;
+
+    /**
+     * Samples of the block buffer already copied to the output.
+     */
+    size_t blockPosition;
+};
+
+/**
+ * Specialization for blocks as long as the output buffer:
+ * the processable renders directly into the output buffer.
+ */
+template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+class AudioBlockAdapter<CHANNEL_NUM, BUFFER_LEN, BUFFER_LEN> : public AudioProcessable {
+public:
+    explicit AudioBlockAdapter(AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &outputBuffer)
+            : outputBuffer(outputBuffer), blockProcessable(nullptr) {};
+
+    inline void setBlockProcessable(AudioProcessable &newBlockProcessable) {
+        blockProcessable = &newBlockProcessable;
+    };
+
+    inline AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &getBlockBuffer() { return outputBuffer; };
+
+    void process() override { blockProcessable->process(); };
+
+    inline void reset() {};
+
+private:
+    AudioBuffer<float, CHANNEL_NUM, BUFFER_LEN> &outputBuffer;
+
+    AudioProcessable *blockProcessable;
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_BLOCK_ADAPTER_H
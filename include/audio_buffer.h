@@ -5,6 +5,8 @@
 
 #include <array>
 #include <algorithm>
+#include "audio_simd.h"
+#include "audio_buffer_expression.h"
 
 
 /**
@@ -89,6 +91,25 @@ public:
      */
     void multiply(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer);
 
+    /**
+     * Sums the element wise product of two AudioBuffers
+     * to this AudioBuffer, in a single pass.
+     *
+     * @param buffer1 first factor of the product
+     * @param buffer2 second factor of the product
+     */
+    void multiplyAdd(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+                     const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer2);
+
+    /**
+     * Sums a second AudioBuffer scaled by a constant gain
+     * to this AudioBuffer, in a single pass.
+     *
+     * @param buffer AudioBuffer to sum to this instance
+     * @param gain multiplicative factor applied to buffer
+     */
+    void addWithGain(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer, float gain);
+
     /**
      * Performs a copy from another buffer of the same dimensions.
      *
@@ -109,6 +130,18 @@ public:
      */
     void clear();
 
+    /**
+     * Evaluates an expression of AudioBuffers (e.g. (a * b + c) * gain)
+     * writing the result in this AudioBuffer. The expression is computed
+     * in a single pass over each channel, without temporary buffers.
+     * This AudioBuffer can appear inside the expression.
+     *
+     * @param expression expression to evaluate
+     * @return reference to this AudioBuffer
+     */
+    template<typename E>
+    AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &operator=(const AudioBufferExpression<E> &expression);
+
 private:
     /**
      * Data structure containing the buffer data.
@@ -130,66 +163,84 @@ private:
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::applyGain(float gain) {
     for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
-        // iterating for each channel
-        T *channel = getWritePointer(channelNumber);
-        for (uint32_t i = 0; i < BUFFER_LEN; i++) {
-            // applying the gain to each sample of the channel
-            channel[i] *= gain;
-        }
+        // applying the gain to each sample of the channel
+        AudioSimd::gain(getWritePointer(channelNumber), gain, BUFFER_LEN);
     }
 }
 
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::add(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) {
     for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
-        // iterating for each channelBuffer1
-        T *channelBuffer1 = getWritePointer(channelNumber);
-        const T *channelBuffer2 = buffer.getReadPointer(channelNumber);
-        for (uint32_t sampleIndex = 0; sampleIndex < BUFFER_LEN; sampleIndex++) {
-            // summing AudioBuffer2 on AudioBuffer1
-            channelBuffer1[sampleIndex] += channelBuffer2[sampleIndex];
-        }
+        // summing AudioBuffer2 on AudioBuffer1
+        AudioSimd::add(getWritePointer(channelNumber), buffer.getReadPointer(channelNumber), BUFFER_LEN);
     }
 }
 
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::multiply(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) {
     for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
-        // iterating for each channelBuffer1
-        T *channelBuffer1 = getWritePointer(channelNumber);
-        const T *channelBuffer2 = buffer.getReadPointer(channelNumber);
-        for (uint32_t sampleIndex = 0; sampleIndex < BUFFER_LEN; sampleIndex++) {
-            // summing AudioBuffer2 on AudioBuffer1
-            channelBuffer1[sampleIndex] *= channelBuffer2[sampleIndex];
-        }
+        // multiplying AudioBuffer2 on AudioBuffer1
+        AudioSimd::multiply(getWritePointer(channelNumber), buffer.getReadPointer(channelNumber), BUFFER_LEN);
+    }
+}
+
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::multiplyAdd(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer1,
+                                                          const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer2) {
+    for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+        AudioSimd::multiplyAdd(getWritePointer(channelNumber),
+                               buffer1.getReadPointer(channelNumber),
+                               buffer2.getReadPointer(channelNumber),
+                               BUFFER_LEN);
+    }
+}
+
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::addWithGain(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer,
+                                                          float gain) {
+    for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+        AudioSimd::gainAdd(getWritePointer(channelNumber), buffer.getReadPointer(channelNumber), gain, BUFFER_LEN);
     }
 }
 
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::copyOnChannel(const AudioBuffer<T, 1, BUFFER_LEN> &audioBuffer,
                                                             size_t channelNumber) {
-
-    T *buffer1 = getWritePointer(channelNumber);
-    const T *buffer2 = audioBuffer.getReadPointer(0);
-    std::copy(buffer2, buffer2 + BUFFER_LEN, buffer1);
+    AudioSimd::copy(getWritePointer(channelNumber), audioBuffer.getReadPointer(0), BUFFER_LEN);
 }
 
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::copyFrom(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &audioBuffer) {
-    T *buffer1;
-    const T *buffer2;
     for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
-        buffer1 = getWritePointer(channelNumber);
-        buffer2 = audioBuffer.getReadPointer(channelNumber);
-        std::copy(buffer2, buffer2 + BUFFER_LEN, buffer1);
+        AudioSimd::copy(getWritePointer(channelNumber), audioBuffer.getReadPointer(channelNumber), BUFFER_LEN);
     }
 }
 
 template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
 void AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::clear() {
     for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
-        bufferContainer[channelNumber].fill(0); // TODO: manage templating generalization
+        AudioSimd::fill(getWritePointer(channelNumber), static_cast<T>(0), BUFFER_LEN);
+    }
+}
+
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+template<typename E>
+AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &
+AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>::operator=(const AudioBufferExpression<E> &expression) {
+    static_assert(std::is_same<typename E::ValueType, T>::value,
+                  "The expression must have the same type of the AudioBuffer");
+    static_assert(E::channelNum == CHANNEL_NUM,
+                  "The expression must have the same number of channels of the AudioBuffer");
+    static_assert(E::bufferLength == BUFFER_LEN,
+                  "The expression must have the same length of the AudioBuffer");
+
+    for (uint32_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+        // the channel of the expression is resolved once, then evaluated in a single pass
+        AudioBufferOperation::evaluate(getWritePointer(channelNumber),
+                                       expression.self().channel(channelNumber),
+                                       BUFFER_LEN);
     }
+    return *this;
 }
 
 #endif //MIOSIX_AUDIO_AUDIO_BUFFER_H
@@ -0,0 +1,309 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_BUFFER_EXPRESSION_H
+#define MIOSIX_AUDIO_AUDIO_BUFFER_EXPRESSION_H
+
+#include <cstddef>
+#include <type_traits>
+#include "audio_simd.h"
+
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+class AudioBuffer;
+
+/**
+ * Base class of the expression templates built combining AudioBuffers
+ * with arithmetic operators.
+ *
+ * An expression like (a * b + c) * gain does not compute anything by itself,
+ * it is evaluated when assigned to an AudioBuffer, in a single pass
+ * over each channel and without temporary buffers.
+ *
+ * Each expression exposes the ValueType, the channelNum and the bufferLength
+ * of the result, and a channel() method returning an object that can be
+ * indexed to get the samples of a channel. For float expressions, the channel
+ * object also exposes a vector() method used to evaluate the expression
+ * with the AudioSimd backend.
+ *
+ * @tparam E type of the expression (CRTP)
+ */
+template<typename E>
+class AudioBufferExpression {
+public:
+    /**
+     * Casts the expression to its actual type.
+     *
+     * @return reference to the derived expression
+     */
+    inline const E &self() const { return static_cast<const E &>(*this); }
+};
+
+/**
+ * Leaf of an expression that reads from an AudioBuffer.
+ * It only stores a reference, the AudioBuffer must outlive the expression.
+ */
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+class AudioBufferTerminal : public AudioBufferExpression<AudioBufferTerminal<T, CHANNEL_NUM, BUFFER_LEN>> {
+public:
+    typedef T ValueType;
+    static constexpr size_t channelNum = CHANNEL_NUM;
+    static constexpr size_t bufferLength = BUFFER_LEN;
+
+    /**
+     * Reads the samples of a channel of the AudioBuffer.
+     */
+    struct Channel {
+        const T *data;
+
+        inline T operator[](size_t i) const { return data[i]; };
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        inline AudioSimd::Detail::Vector vector(size_t i) const { return AudioSimd::Detail::load(data + i); };
+
+#endif
+    };
+
+    explicit AudioBufferTerminal(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) : buffer(buffer) {};
+
+    inline Channel channel(size_t channelNumber) const { return Channel{buffer.getReadPointer(channelNumber)}; };
+
+private:
+    const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer;
+};
+
+/**
+ * Leaf of an expression containing a constant, that is
+ * broadcast on every sample of every channel.
+ * The constant is converted to the type of the AudioBuffers
+ * of the expression.
+ */
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+class AudioBufferScalar : public AudioBufferExpression<AudioBufferScalar<T, CHANNEL_NUM, BUFFER_LEN>> {
+public:
+    typedef T ValueType;
+    static constexpr size_t channelNum = CHANNEL_NUM;
+    static constexpr size_t bufferLength = BUFFER_LEN;
+
+    /**
+     * The same value is returned for each index.
+     */
+    struct Channel {
+        T value;
+
+        inline T operator[](size_t) const { return value; };
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        inline AudioSimd::Detail::Vector vector(size_t) const { return AudioSimd::Detail::broadcast(value); };
+
+#endif
+    };
+
+    explicit AudioBufferScalar(T value) : value(value) {};
+
+    inline Channel channel(size_t) const { return Channel{value}; };
+
+private:
+    T value;
+};
+
+/**
+ * Element wise operations that can be used in an AudioBufferBinaryExpression.
+ */
+namespace AudioBufferOperation {
+    struct Add {
+        template<typename T>
+        static inline T apply(T a, T b) { return a + b; }
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        static inline AudioSimd::Detail::Vector apply(AudioSimd::Detail::Vector a, AudioSimd::Detail::Vector b) {
+            return AudioSimd::Detail::add(a, b);
+        }
+
+#endif
+    };
+
+    struct Subtract {
+        template<typename T>
+        static inline T apply(T a, T b) { return a - b; }
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        static inline AudioSimd::Detail::Vector apply(AudioSimd::Detail::Vector a, AudioSimd::Detail::Vector b) {
+            return AudioSimd::Detail::subtract(a, b);
+        }
+
+#endif
+    };
+
+    struct Multiply {
+        template<typename T>
+        static inline T apply(T a, T b) { return a * b; }
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        static inline AudioSimd::Detail::Vector apply(AudioSimd::Detail::Vector a, AudioSimd::Detail::Vector b) {
+            return AudioSimd::Detail::multiply(a, b);
+        }
+
+#endif
+    };
+
+    /**
+     * Writes the samples of the channel of an expression into an array.
+     *
+     * @param dst destination array
+     * @param source channel object of the expression
+     * @param n number of samples
+     */
+    template<typename T, typename Source>
+    inline void evaluate(T *dst, const Source &source, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = source[i];
+        }
+    }
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+    template<typename Source>
+    inline void evaluate(float *dst, const Source &source, size_t n) {
+        const size_t vectorEnd = n - (n % AudioSimd::Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += AudioSimd::Detail::width) {
+            AudioSimd::Detail::store(dst + i, source.vector(i));
+        }
+        for (; i < n; i++) {
+            dst[i] = source[i];
+        }
+    }
+
+#endif
+}
+
+/**
+ * Node of an expression applying an element wise operation
+ * between two sub expressions.
+ *
+ * @tparam L left operand
+ * @tparam R right operand
+ * @tparam Operation one of the structs in AudioBufferOperation
+ */
+template<typename L, typename R, typename Operation>
+class AudioBufferBinaryExpression : public AudioBufferExpression<AudioBufferBinaryExpression<L, R, Operation>> {
+public:
+    static_assert(std::is_same<typename L::ValueType, typename R::ValueType>::value,
+                  "AudioBuffer expressions must combine buffers of the same type");
+    static_assert(L::channelNum == R::channelNum,
+                  "AudioBuffer expressions must combine buffers with the same number of channels");
+    static_assert(L::bufferLength == R::bufferLength,
+                  "AudioBuffer expressions must combine buffers with the same length");
+
+    typedef typename L::ValueType ValueType;
+    static constexpr size_t channelNum = L::channelNum;
+    static constexpr size_t bufferLength = L::bufferLength;
+
+    /**
+     * Evaluates the operation sample by sample, the channels of
+     * the operands are resolved once for the whole channel.
+     */
+    struct Channel {
+        decltype(std::declval<const L &>().channel(0)) left;
+        decltype(std::declval<const R &>().channel(0)) right;
+
+        inline ValueType operator[](size_t i) const { return Operation::apply(left[i], right[i]); };
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+        inline AudioSimd::Detail::Vector vector(size_t i) const {
+            return Operation::apply(left.vector(i), right.vector(i));
+        };
+
+#endif
+    };
+
+    AudioBufferBinaryExpression(const L &left, const R &right) : left(left), right(right) {};
+
+    inline Channel channel(size_t channelNumber) const {
+        return Channel{left.channel(channelNumber), right.channel(channelNumber)};
+    };
+
+private:
+    L left;
+    R right;
+};
+
+/**
+ * Trait converting the operands of the arithmetic operators into
+ * expressions. It is defined only for AudioBuffers and expressions,
+ * so that the operators do not take part in the overload
+ * resolution for other types.
+ */
+template<typename X, typename = void>
+struct AudioBufferOperand {
+};
+
+template<typename T, size_t CHANNEL_NUM, size_t BUFFER_LEN>
+struct AudioBufferOperand<AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN>> {
+    typedef AudioBufferTerminal<T, CHANNEL_NUM, BUFFER_LEN> type;
+
+    static inline type wrap(const AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) { return type(buffer); }
+};
+
+template<typename E>
+struct AudioBufferOperand<E, typename std::enable_if<std::is_base_of<AudioBufferExpression<E>, E>::value>::type> {
+    typedef E type;
+
+    static inline const E &wrap(const E &expression) { return expression; }
+};
+
+/**
+ * Trait building the scalar leaf compatible with an operand.
+ */
+template<typename X, typename S, typename = void>
+struct AudioBufferScalarOperand {
+};
+
+template<typename X, typename S>
+struct AudioBufferScalarOperand<X, S, typename std::enable_if<
+        std::is_class<typename AudioBufferOperand<X>::type>::value>::type> {
+    typedef typename AudioBufferOperand<X>::type Operand;
+    typedef AudioBufferScalar<typename Operand::ValueType, Operand::channelNum, Operand::bufferLength> type;
+
+    static inline type wrap(S value) { return type(static_cast<typename Operand::ValueType>(value)); }
+};
+
+/**
+ * Defines an operator between two operands, and between an
+ * operand and an arithmetic scalar (on both sides).
+ */
+#define AUDIO_BUFFER_EXPRESSION_OPERATOR(SYMBOL, OPERATION)                                                  \
+template<typename L, typename R>                                                                             \
+inline AudioBufferBinaryExpression<typename AudioBufferOperand<L>::type,                                     \
+                                   typename AudioBufferOperand<R>::type, OPERATION>                          \
+operator SYMBOL(const L &left, const R &right) {                                                             \
+    return {AudioBufferOperand<L>::wrap(left), AudioBufferOperand<R>::wrap(right)};                          \
+}                                                                                                            \
+                                                                                                             \
+template<typename L, typename S, typename = typename std::enable_if<std::is_arithmetic<S>::value>::type>    \
+inline AudioBufferBinaryExpression<typename AudioBufferOperand<L>::type,                                     \
+                                   typename AudioBufferScalarOperand<L, S>::type, OPERATION>                 \
+operator SYMBOL(const L &left, S right) {                                                                    \
+    return {AudioBufferOperand<L>::wrap(left), AudioBufferScalarOperand<L, S>::wrap(right)};                 \
+}                                                                                                            \
+                                                                                                             \
+template<typename S, typename R, typename = typename std::enable_if<std::is_arithmetic<S>::value>::type>    \
+inline AudioBufferBinaryExpression<typename AudioBufferScalarOperand<R, S>::type,                            \
+                                   typename AudioBufferOperand<R>::type, OPERATION>                          \
+operator SYMBOL(S left, const R &right) {                                                                    \
+    return {AudioBufferScalarOperand<R, S>::wrap(left), AudioBufferOperand<R>::wrap(right)};                 \
+}
+
+AUDIO_BUFFER_EXPRESSION_OPERATOR(+, AudioBufferOperation::Add)
+
+AUDIO_BUFFER_EXPRESSION_OPERATOR(-, AudioBufferOperation::Subtract)
+
+AUDIO_BUFFER_EXPRESSION_OPERATOR(*, AudioBufferOperation::Multiply)
+
+#undef AUDIO_BUFFER_EXPRESSION_OPERATOR
+
+#endif //MIOSIX_AUDIO_AUDIO_BUFFER_EXPRESSION_H
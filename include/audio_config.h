@@ -22,5 +22,22 @@
  */
 #define AUDIO_DRIVER_BIT_DEPTH 16
 
+/**
+ * Size of the blocks rendered by the AudioProcessor and its AudioModules.
+ * It can be smaller than AUDIO_DRIVER_BUFFER_SIZE, e.g. for a finer
+ * modulation rate, or larger, e.g. for FFT based processing.
+ */
+#ifndef AUDIO_PROCESSOR_BLOCK_SIZE
+#define AUDIO_PROCESSOR_BLOCK_SIZE AUDIO_DRIVER_BUFFER_SIZE
+#endif
+
+/**
+ * If not 0, the profiling scopes of audio_profiler.h time the
+ * AudioModules and the AudioProcessor, otherwise they are compiled out.
+ */
+#ifndef AUDIO_PROFILING
+#define AUDIO_PROFILING 0
+#endif
+
 
 #endif //MIOSIX_AUDIO_AUDIO_CONFIG_H
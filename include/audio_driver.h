@@ -2,9 +2,16 @@
 #ifndef MIOSIX_AUDIO_DRIVER_AUDIO_H
 #define MIOSIX_AUDIO_DRIVER_AUDIO_H
 
+#include <cstdint>
 #include "audio_config.h"
 #include "audio_processable.h"
 #include "audio_buffer.h"
+#include "audio_block_adapter.h"
+#include "audio_load_meter.h"
+#include "audio_pcm.h"
+
+static_assert(AUDIO_DRIVER_BIT_DEPTH >= 16 && AUDIO_DRIVER_BIT_DEPTH <= 32,
+              "AUDIO_DRIVER_BIT_DEPTH must be between 16 and 32");
 
 // TODO: make the output buffer working with a custom type (int, double, float...)
 
@@ -20,9 +27,14 @@ class AudioDriver {
 public:
 
     /**
-     * Constructor.
+     * Constructor, the driver starts with the values of audio_config.h.
      */
-    AudioDriver() {};
+    AudioDriver() : bufferSize(AUDIO_DRIVER_BUFFER_SIZE),
+                    audioProcessable(nullptr),
+                    sampleRate(AUDIO_DRIVER_SAMPLE_RATE),
+                    blockAdapter(audioBuffer),
+                    meteredCallback(blockAdapter, loadMeter),
+                    volume(1.0f) {};
 
     /**
      * Initializes the audio driver.
@@ -38,6 +50,8 @@ public:
 
     /**
      * Getter for audioProcessable.
+     * Note: it renders a block of AUDIO_PROCESSOR_BLOCK_SIZE samples, the
+     * driver implementation fills the AudioBuffer through getCallback().
      *
      * @return audioProcessable
      */
@@ -45,6 +59,18 @@ public:
         return *audioProcessable;
     }
 
+    /**
+     * Getter for the callback to be called by the driver implementation
+     * once per buffer: it fills the AudioBuffer with the blocks of
+     * AUDIO_PROCESSOR_BLOCK_SIZE samples rendered by the audioProcessable.
+     * Its execution time is measured by the load meter.
+     *
+     * @return callback filling the AudioBuffer
+     */
+    inline AudioProcessable &getCallback() {
+        return meteredCallback;
+    }
+
     /**
      * Set the audio processable, this method must be called
      * after the init method.
@@ -52,6 +78,8 @@ public:
      */
     inline void setAudioProcessable(AudioProcessable &newAudioProcessable) {
         audioProcessable = &newAudioProcessable;
+        blockAdapter.setBlockProcessable(newAudioProcessable);
+        blockAdapter.reset();
     }
 
     /**
@@ -61,6 +89,15 @@ public:
      */
     AudioBuffer<float, 2, AUDIO_DRIVER_BUFFER_SIZE> &getBuffer() { return audioBuffer; };
 
+    /**
+     * Getter for the buffer rendered by the audioProcessable at each call,
+     * it is the AudioBuffer itself when AUDIO_PROCESSOR_BLOCK_SIZE
+     * is equal to AUDIO_DRIVER_BUFFER_SIZE.
+     *
+     * @return block buffer
+     */
+    AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &getProcessingBuffer() { return blockAdapter.getBlockBuffer(); };
+
     /**
      * Getter method for the bufferSize.
      *
@@ -91,6 +128,29 @@ public:
      */
     inline float getVolume() { return volume; };
 
+    /**
+     * Sets the dither applied when the float buffer is
+     * converted to the integer samples of the DAC.
+     *
+     * @param dither dither to apply
+     */
+    inline void setDither(PcmDither dither) { outputConverter.setDither(dither); };
+
+    /**
+     * Getter for the dither of the output conversion.
+     *
+     * @return dither
+     */
+    inline PcmDither getDither() const { return outputConverter.getDither(); };
+
+    /**
+     * Getter for the load meter of the callback, whose load and
+     * xrun counts can be read from a monitoring thread.
+     *
+     * @return load meter
+     */
+    inline AudioLoadMeter &getLoadMeter() { return loadMeter; };
+
     /**
      * Destructor.
      */
@@ -131,22 +191,69 @@ private:
      */
     AudioBuffer<float, 2, AUDIO_DRIVER_BUFFER_SIZE> audioBuffer;
 
+    /**
+     * Re-blocking between the audioProcessable and the AudioBuffer.
+     */
+    AudioBlockAdapter<2, AUDIO_PROCESSOR_BLOCK_SIZE, AUDIO_DRIVER_BUFFER_SIZE> blockAdapter;
+
+    /**
+     * Load of the callback, relative to the period of the AudioBuffer.
+     */
+    AudioLoadMeter loadMeter;
+
+    /**
+     * The blockAdapter measured by the loadMeter.
+     */
+    MeteredAudioProcessable meteredCallback;
+
     /**
      * Volume value of the audio driver.
      */
     float volume;
 
+    /**
+     * Converter from the float buffer to the DAC samples.
+     */
+    PcmConverter outputConverter;
+
 protected:
 
     /**
      * Setup of the sample rate from SampleRate enum class
      */
-    void setSampleRate(uint32_t newSampleRate) {};
+    void setSampleRate(uint32_t newSampleRate) {
+        sampleRate = static_cast<float>(newSampleRate);
+        loadMeter.setSampleRate(sampleRate);
+    };
+
+    /**
+     * Counts an xrun detected by the driver implementation, e.g. a DMA underrun.
+     */
+    inline void reportXrun() { loadMeter.reportXrun(); };
 
     /**
-     * Utility method to copy current float buffers to the DAC integer output buffer
+     * Utility method to copy current float buffers to the DAC integer output buffer.
+     * The samples are clipped in [-1.0, 1.0], quantized to 16 bits, with the
+     * dither set by setDither(), and interleaved (left, right, left, ...).
+     *
+     * @param writableRawBuffer output buffer of 2 * AUDIO_DRIVER_BUFFER_SIZE samples
+     */
+    void writeToOutputBuffer(int16_t *writableRawBuffer) {
+        outputConverter.convert(writableRawBuffer, audioBuffer.getReadPointer(0),
+                                audioBuffer.getReadPointer(1), AUDIO_DRIVER_BUFFER_SIZE);
+    };
+
+    /**
+     * Utility method to copy current float buffers to the DAC integer output buffer,
+     * for DACs with 32 bit slots. The samples are quantized to AUDIO_DRIVER_BIT_DEPTH
+     * bits, right justified, and interleaved (left, right, left, ...).
+     *
+     * @param writableRawBuffer output buffer of 2 * AUDIO_DRIVER_BUFFER_SIZE samples
      */
-    void writeToOutputBuffer(int16_t *writableRawBuffer) {};
+    void writeToOutputBuffer(int32_t *writableRawBuffer) {
+        outputConverter.convert(writableRawBuffer, audioBuffer.getReadPointer(0),
+                                audioBuffer.getReadPointer(1), AUDIO_DRIVER_BUFFER_SIZE, AUDIO_DRIVER_BIT_DEPTH);
+    };
 
 };
 
@@ -0,0 +1,380 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_GRAPH_H
+#define MIOSIX_AUDIO_AUDIO_GRAPH_H
+
+#include <array>
+#include <cstddef>
+#include "audio_config.h"
+#include "audio_buffer.h"
+#include "audio_module.h"
+
+/**
+ * Graph of AudioModules, executed once per block.
+ *
+ * The modules are added as nodes, and connected from the output of a node
+ * to the input of another one: the inputs of a node are summed into its
+ * buffer before its process() is called, a node without inputs starts from
+ * a cleared buffer. The ports are typed by the channel number of the graph,
+ * so connecting modules with a different number of channels does not compile.
+ *
+ * build() computes the execution order once, with a topological sort,
+ * and assigns the buffers of the nodes from a fixed pool: a buffer is
+ * reused as soon as its last reader has run, and a node whose input is
+ * not read by anyone else processes that input in place.
+ * process() then follows the precomputed schedule, without allocations
+ * and with a single virtual call per node.
+ *
+ * A graph built for parallel execution can be processed by an
+ * AudioGraphScheduler, that runs the independent branches on several threads.
+ *
+ * The graph must not be changed while it is processed.
+ *
+ * @tparam CHANNEL_NUM number of channels of the modules
+ * @tparam MAX_NODES maximum number of nodes
+ * @tparam MAX_BUFFERS number of buffers of the pool
+ * @tparam MAX_EDGES maximum number of connections
+ */
+template<size_t CHANNEL_NUM, size_t MAX_NODES, size_t MAX_BUFFERS = MAX_NODES, size_t MAX_EDGES = 2 * MAX_NODES>
+class AudioGraph {
+public:
+    typedef AudioBuffer<float, CHANNEL_NUM, AUDIO_PROCESSOR_BLOCK_SIZE> Buffer;
+
+    typedef size_t NodeId;
+
+    /**
+     * Id returned when the graph is full.
+     */
+    static constexpr NodeId invalidId = MAX_NODES;
+
+    static constexpr size_t maxNodes = MAX_NODES;
+
+    /**
+     * Constructor.
+     */
+    AudioGraph() : nodeNumber(0), edgeNumber(0), outputNode(invalidId), outputSlot(0), usedBuffers(0),
+                   built(false) {};
+
+    /**
+     * Adds a module to the graph.
+     *
+     * @param module module to process
+     * @return id of the node, or invalidId if the graph is full
+     */
+    NodeId add(AudioModule<CHANNEL_NUM> &module) {
+        if (nodeNumber == MAX_NODES) return invalidId;
+        modules[nodeNumber] = &module;
+        built = false;
+        return nodeNumber++;
+    }
+
+    /**
+     * Connects the output of a node to the input of another one.
+     *
+     * @param from source node
+     * @param to destination node
+     * @return false if the nodes are not valid, already connected, or the graph is full
+     */
+    bool connect(NodeId from, NodeId to) {
+        if (from >= nodeNumber || to >= nodeNumber || from == to || edgeNumber == MAX_EDGES) return false;
+        for (size_t e = 0; e < edgeNumber; e++) {
+            if (edges[e].from == from && edges[e].to == to) return false;
+        }
+        edges[edgeNumber++] = {from, to};
+        built = false;
+        return true;
+    }
+
+    /**
+     * Sets the node whose buffer is the output of the graph.
+     *
+     * @param node output node
+     */
+    inline void setOutput(NodeId node) {
+        outputNode = node;
+        built = false;
+    };
+
+    /**
+     * Computes the schedule and assigns the buffers,
+     * to be called after the graph is changed.
+     *
+     * For a parallel execution the order of the schedule is not guaranteed
+     * between independent branches, so a buffer is never reused by
+     * another branch, and an input is processed in place only by its
+     * single reader.
+     *
+     * @param parallel if true, the buffers are assigned for a parallel execution
+     * @return false if the graph has a cycle, has no output,
+     * or needs more than MAX_BUFFERS buffers
+     */
+    bool build(bool parallel = false) {
+        built = false;
+        if (outputNode >= nodeNumber) return false;
+
+        // Kahn's algorithm, visiting the ready nodes in insertion order
+        std::array<size_t, MAX_NODES> pendingInputs;
+        pendingInputs.fill(0);
+        for (size_t e = 0; e < edgeNumber; e++) pendingInputs[edges[e].to]++;
+        size_t scheduled = 0;
+        for (NodeId node = 0; node < nodeNumber; node++) {
+            if (pendingInputs[node] == 0) order[scheduled++] = node;
+        }
+        for (size_t position = 0; position < scheduled; position++) {
+            for (size_t e = 0; e < edgeNumber; e++) {
+                if (edges[e].from == order[position] && --pendingInputs[edges[e].to] == 0) {
+                    order[scheduled++] = edges[e].to;
+                }
+            }
+        }
+        if (scheduled != nodeNumber) return false;
+
+        // liveness: a buffer is needed until the last reader of its node
+        std::array<size_t, MAX_NODES> positions;
+        std::array<size_t, MAX_NODES> lastUse;
+        for (size_t position = 0; position < nodeNumber; position++) {
+            positions[order[position]] = position;
+            lastUse[order[position]] = position;
+        }
+        for (size_t e = 0; e < edgeNumber; e++) {
+            const size_t reader = positions[edges[e].to];
+            lastUse[edges[e].from] = (reader > lastUse[edges[e].from]) ? reader : lastUse[edges[e].from];
+        }
+        lastUse[outputNode] = nodeNumber;
+
+        // dependencies between the positions of the schedule
+        size_t successorNumber = 0;
+        std::array<size_t, MAX_NODES> readers;
+        for (size_t position = 0; position < nodeNumber; position++) {
+            Step &step = steps[position];
+            step.predecessorNumber = 0;
+            step.successorBegin = successorNumber;
+            for (size_t e = 0; e < edgeNumber; e++) {
+                if (edges[e].from == order[position]) successors[successorNumber++] = positions[edges[e].to];
+                if (edges[e].to == order[position]) step.predecessorNumber++;
+            }
+            step.successorNumber = successorNumber - step.successorBegin;
+            readers[order[position]] = step.successorNumber;
+        }
+
+        // linear scan over the schedule, with a stack of free buffers
+        std::array<size_t, MAX_BUFFERS> freeSlots;
+        size_t freeNumber = 0;
+        size_t nextSlot = 0;
+        std::array<size_t, MAX_NODES> nodeSlots;
+        size_t inputNumber = 0;
+        for (size_t position = 0; position < nodeNumber; position++) {
+            const NodeId node = order[position];
+            Step &step = steps[position];
+            step.module = modules[node];
+            step.inputBegin = inputNumber;
+            step.inPlace = false;
+
+            // an input read for the last time is processed in place
+            for (size_t e = 0; e < edgeNumber; e++) {
+                if (edges[e].to == node && !step.inPlace && lastUse[edges[e].from] == position &&
+                    (!parallel || readers[edges[e].from] == 1)) {
+                    step.slot = nodeSlots[edges[e].from];
+                    step.inPlace = true;
+                    inputSlots[inputNumber++] = step.slot;
+                }
+            }
+            if (!step.inPlace) {
+                if (freeNumber > 0) {
+                    step.slot = freeSlots[--freeNumber];
+                } else if (nextSlot < MAX_BUFFERS) {
+                    step.slot = nextSlot++;
+                } else {
+                    return false;
+                }
+            }
+            for (size_t e = 0; e < edgeNumber; e++) {
+                const NodeId input = edges[e].from;
+                if (edges[e].to == node && !(step.inPlace && nodeSlots[input] == step.slot)) {
+                    inputSlots[inputNumber++] = nodeSlots[input];
+                    if (lastUse[input] == position && !parallel) freeSlots[freeNumber++] = nodeSlots[input];
+                }
+            }
+            step.inputNumber = inputNumber - step.inputBegin;
+            nodeSlots[node] = step.slot;
+
+            // the buffer of a node without readers is only used by the node itself
+            if (lastUse[node] == position && !parallel) freeSlots[freeNumber++] = step.slot;
+        }
+        outputSlot = nodeSlots[outputNode];
+        usedBuffers = nextSlot;
+        built = true;
+        return true;
+    }
+
+    /**
+     * Processes a block, following the schedule computed by build().
+     * The output is cleared if the graph is not built.
+     *
+     * @param output buffer where the output node is copied
+     */
+    void process(Buffer &output) {
+        if (!built) {
+            output.clear();
+            return;
+        }
+        for (size_t position = 0; position < nodeNumber; position++) {
+            processStep(position);
+        }
+        copyOutput(output);
+    }
+
+    /**
+     * Sums the inputs and processes the node at a certain position of the
+     * schedule, the nodes it depends on must have been processed.
+     *
+     * @param position position of the node in the schedule
+     */
+    void processStep(size_t position) {
+        const Step &step = steps[position];
+        Buffer &buffer = pool[step.slot];
+        size_t input = step.inputBegin;
+        const size_t inputEnd = step.inputBegin + step.inputNumber;
+        if (step.inPlace) {
+            input++;
+        } else if (input == inputEnd) {
+            buffer.clear();
+        } else {
+            buffer.copyFrom(pool[inputSlots[input++]]);
+        }
+        for (; input < inputEnd; input++) {
+            buffer.add(pool[inputSlots[input]]);
+        }
+        step.module->process(buffer);
+    }
+
+    /**
+     * Copies the buffer of the output node, once all the nodes are processed.
+     *
+     * @param output destination buffer
+     */
+    inline void copyOutput(Buffer &output) const { output.copyFrom(pool[outputSlot]); };
+
+    /**
+     * Number of nodes that must be processed before a node.
+     *
+     * @param position position of the node in the schedule
+     * @return number of inputs
+     */
+    inline size_t getPredecessorNumber(size_t position) const { return steps[position].predecessorNumber; };
+
+    /**
+     * Number of nodes reading a node.
+     *
+     * @param position position of the node in the schedule
+     * @return number of outputs
+     */
+    inline size_t getSuccessorNumber(size_t position) const { return steps[position].successorNumber; };
+
+    /**
+     * Node reading a node.
+     *
+     * @param position position of the node in the schedule
+     * @param index index of the successor, lower than getSuccessorNumber()
+     * @return position of the successor in the schedule
+     */
+    inline size_t getSuccessor(size_t position, size_t index) const {
+        return successors[steps[position].successorBegin + index];
+    };
+
+    /**
+     * Indicates if the graph is ready to be processed.
+     *
+     * @return true after a successful build()
+     */
+    inline bool isBuilt() const { return built; };
+
+    /**
+     * Number of nodes.
+     *
+     * @return size
+     */
+    inline size_t size() const { return nodeNumber; };
+
+    /**
+     * Number of buffers of the pool used by the schedule.
+     *
+     * @return buffer count
+     */
+    inline size_t getBufferCount() const { return usedBuffers; };
+
+    /**
+     * Node executed at a certain position of the schedule.
+     *
+     * @param position position, lower than size()
+     * @return node id
+     */
+    inline NodeId getScheduledNode(size_t position) const { return order[position]; };
+
+    AudioGraph(const AudioGraph &) = delete;
+
+    AudioGraph &operator=(const AudioGraph &) = delete;
+
+private:
+
+    struct Edge {
+        NodeId from;
+        NodeId to;
+    };
+
+    /**
+     * Precomputed execution of a node.
+     */
+    struct Step {
+        AudioModule<CHANNEL_NUM> *module;
+
+        /**
+         * Buffer of the node in the pool.
+         */
+        size_t slot;
+
+        /**
+         * Range of inputSlots with the buffers to be summed,
+         * the first one is the node buffer itself when inPlace.
+         */
+        size_t inputBegin;
+        size_t inputNumber;
+        bool inPlace;
+
+        /**
+         * Dependencies, the successors are a range of the successors array.
+         */
+        size_t predecessorNumber;
+        size_t successorBegin;
+        size_t successorNumber;
+    };
+
+    std::array<AudioModule<CHANNEL_NUM> *, MAX_NODES> modules;
+    size_t nodeNumber;
+
+    std::array<Edge, MAX_EDGES> edges;
+    size_t edgeNumber;
+
+    NodeId outputNode;
+
+    /**
+     * Schedule computed by build().
+     */
+    std::array<NodeId, MAX_NODES> order;
+    std::array<Step, MAX_NODES> steps;
+    std::array<size_t, MAX_EDGES> inputSlots;
+    std::array<size_t, MAX_EDGES> successors;
+    size_t outputSlot;
+    size_t usedBuffers;
+    bool built;
+
+    std::array<Buffer, MAX_BUFFERS> pool;
+};
+
+template<size_t CHANNEL_NUM, size_t MAX_NODES, size_t MAX_BUFFERS, size_t MAX_EDGES>
+constexpr typename AudioGraph<CHANNEL_NUM, MAX_NODES, MAX_BUFFERS, MAX_EDGES>::NodeId
+        AudioGraph<CHANNEL_NUM, MAX_NODES, MAX_BUFFERS, MAX_EDGES>::invalidId;
+
+template<size_t CHANNEL_NUM, size_t MAX_NODES, size_t MAX_BUFFERS, size_t MAX_EDGES>
+constexpr size_t AudioGraph<CHANNEL_NUM, MAX_NODES, MAX_BUFFERS, MAX_EDGES>::maxNodes;
+
+#endif //MIOSIX_AUDIO_AUDIO_GRAPH_H
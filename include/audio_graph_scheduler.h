@@ -0,0 +1,304 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_GRAPH_SCHEDULER_H
+#define MIOSIX_AUDIO_AUDIO_GRAPH_SCHEDULER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "audio_math.h"
+
+#if defined(__linux__)
+
+#include <climits>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#endif
+
+/**
+ * Bounded work stealing deque (Chase-Lev) of node positions: the owner
+ * thread pushes and pops at the bottom, the other threads steal from the top.
+ * The indices only grow, so a stale thief cannot take a slot twice.
+ *
+ * @tparam CAPACITY maximum number of queued tasks, a power of two
+ */
+template<size_t CAPACITY>
+class AudioGraphWorkQueue {
+public:
+    AudioGraphWorkQueue() : top(0), bottom(0) {};
+
+    /**
+     * Owner: queues a task.
+     */
+    inline void push(size_t task) {
+        const int64_t b = bottom.load(std::memory_order_relaxed);
+        tasks[static_cast<size_t>(b) & mask].store(task, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+    };
+
+    /**
+     * Owner: takes the last queued task.
+     *
+     * @return false if the queue is empty
+     */
+    bool pop(size_t &task) {
+        const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_seq_cst);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        task = tasks[static_cast<size_t>(b) & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last task, racing with the thieves
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * Thief: takes the first queued task.
+     *
+     * @return false if the queue is empty or another thread took the task
+     */
+    bool steal(size_t &task) {
+        int64_t t = top.load(std::memory_order_seq_cst);
+        const int64_t b = bottom.load(std::memory_order_seq_cst);
+        if (t >= b) return false;
+        task = tasks[static_cast<size_t>(t) & mask].load(std::memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst);
+    }
+
+private:
+    static constexpr size_t mask = CAPACITY - 1;
+
+    std::atomic<int64_t> top;
+    std::atomic<int64_t> bottom;
+    std::array<std::atomic<size_t>, CAPACITY> tasks;
+};
+
+/**
+ * Parallel executor of an AudioGraph built with build(true).
+ *
+ * The thread calling process(), usually the audio callback, is helped by
+ * a pool of worker threads, each one optionally pinned to a core.
+ * At each block every node gets an atomic counter of the inputs still
+ * to be processed: the thread completing the last input of a node queues
+ * it in its own work stealing deque, and idle threads steal from the
+ * deques of the others, so independent branches run in parallel.
+ *
+ * Between the blocks the workers spin for a while, to catch the next block
+ * without the latency of a wake up, then sleep on a futex (on Linux,
+ * elsewhere they yield) until the audio thread publishes a new block.
+ *
+ * @tparam Graph type of the AudioGraph
+ * @tparam MAX_THREADS maximum number of threads, including the audio thread
+ */
+template<typename Graph, size_t MAX_THREADS = 8>
+class AudioGraphScheduler {
+public:
+
+    /**
+     * Constructor, starts the workers.
+     *
+     * @param graph graph to process, built for parallel execution
+     * @param threadNumber number of threads processing the graph, including the
+     * thread calling process(), between 1 and MAX_THREADS
+     * @param pinThreads if true, each worker is pinned to a different core
+     * @param spinIterations number of checks for a new block before a worker sleeps
+     */
+    AudioGraphScheduler(Graph &graph, size_t threadNumber, bool pinThreads = true, size_t spinIterations = 4096)
+            : graph(graph),
+              threadNumber((threadNumber == 0) ? 1 : (threadNumber > MAX_THREADS) ? MAX_THREADS : threadNumber),
+              spinIterations(spinIterations),
+              remaining(0),
+              epoch(0),
+              sleepers(0),
+              running(true) {
+        for (size_t worker = 1; worker < this->threadNumber; worker++) {
+            workers[worker] = std::thread([this, worker] { runWorker(worker); });
+            if (pinThreads) pin(workers[worker], worker);
+        }
+    };
+
+    /**
+     * Destructor, stops the workers.
+     */
+    ~AudioGraphScheduler() {
+        running.store(false, std::memory_order_seq_cst);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        wakeWorkers();
+        for (size_t worker = 1; worker < threadNumber; worker++) workers[worker].join();
+    };
+
+    /**
+     * Processes a block of the graph, returning when all the nodes are processed.
+     *
+     * @param output buffer where the output node is copied
+     */
+    void process(typename Graph::Buffer &output) {
+        if (!graph.isBuilt()) {
+            output.clear();
+            return;
+        }
+        const size_t nodeNumber = graph.size();
+        for (size_t position = 0; position < nodeNumber; position++) {
+            pending[position].store(graph.getPredecessorNumber(position), std::memory_order_relaxed);
+        }
+        remaining.store(nodeNumber, std::memory_order_relaxed);
+        for (size_t position = 0; position < nodeNumber; position++) {
+            if (graph.getPredecessorNumber(position) == 0) queues[0].push(position);
+        }
+
+        // publishing the block
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) wakeWorkers();
+
+        work(0);
+        graph.copyOutput(output);
+    };
+
+    /**
+     * Number of threads processing the graph.
+     *
+     * @return threads, including the audio thread
+     */
+    inline size_t getThreadNumber() const { return threadNumber; };
+
+    AudioGraphScheduler(const AudioGraphScheduler &) = delete;
+
+    AudioGraphScheduler &operator=(const AudioGraphScheduler &) = delete;
+
+private:
+    static constexpr size_t queueCapacity = AudioMath::nextPowerOfTwo(Graph::maxNodes);
+
+    /**
+     * Processes the queued nodes until the block is complete.
+     *
+     * @param self index of the thread
+     */
+    void work(size_t self) {
+        size_t idle = 0;
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            size_t task;
+            if (queues[self].pop(task) || steal(self, task)) {
+                execute(self, task);
+                idle = 0;
+            } else if (++idle > spinIterations) {
+                // the threads holding the tasks may be waiting for a core
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    /**
+     * Tries to steal a task from the other threads.
+     */
+    inline bool steal(size_t self, size_t &task) {
+        for (size_t i = 1; i < threadNumber; i++) {
+            if (queues[(self + i) % threadNumber].steal(task)) return true;
+        }
+        return false;
+    };
+
+    /**
+     * Processes a node and queues the successors that become ready.
+     */
+    inline void execute(size_t self, size_t position) {
+        graph.processStep(position);
+        const size_t successorNumber = graph.getSuccessorNumber(position);
+        for (size_t i = 0; i < successorNumber; i++) {
+            const size_t successor = graph.getSuccessor(position, i);
+            if (pending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) queues[self].push(successor);
+        }
+        remaining.fetch_sub(1, std::memory_order_acq_rel);
+    };
+
+    /**
+     * Body of a worker thread.
+     */
+    void runWorker(size_t self) {
+        uint32_t seen = 0;
+        while (true) {
+            // spin, then sleep until a new block is published
+            size_t spins = 0;
+            while (epoch.load(std::memory_order_acquire) == seen) {
+                if (++spins < spinIterations) continue;
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                waitForEpoch(seen);
+                sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            }
+            seen = epoch.load(std::memory_order_acquire);
+            if (!running.load(std::memory_order_acquire)) return;
+            work(self);
+        }
+    };
+
+    /**
+     * Sleeps while the epoch is equal to a value, returning also on spurious wake ups.
+     */
+    inline void waitForEpoch(uint32_t value) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+        if (epoch.load(std::memory_order_acquire) == value) std::this_thread::yield();
+#endif
+    };
+
+    inline void wakeWorkers() {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    };
+
+    /**
+     * Pins a worker to a core, where supported.
+     */
+    static void pin(std::thread &thread, size_t worker) {
+#if defined(__linux__)
+        const unsigned int cores = std::thread::hardware_concurrency();
+        if (cores == 0) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker % cores, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &set);
+#else
+        (void) thread;
+        (void) worker;
+#endif
+    };
+
+    Graph &graph;
+    const size_t threadNumber;
+    const size_t spinIterations;
+
+    /**
+     * Number of inputs still to be processed, for each position of the schedule.
+     */
+    std::array<std::atomic<size_t>, Graph::maxNodes> pending;
+
+    /**
+     * Number of nodes of the block still to be processed.
+     */
+    std::atomic<size_t> remaining;
+
+    /**
+     * Incremented at each block, the workers sleep on it.
+     */
+    std::atomic<uint32_t> epoch;
+    std::atomic<size_t> sleepers;
+    std::atomic<bool> running;
+
+    std::array<AudioGraphWorkQueue<queueCapacity>, MAX_THREADS> queues;
+    std::array<std::thread, MAX_THREADS> workers;
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_GRAPH_SCHEDULER_H
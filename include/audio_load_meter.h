@@ -0,0 +1,225 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_LOAD_METER_H
+#define MIOSIX_AUDIO_AUDIO_LOAD_METER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include "audio_config.h"
+#include "audio_processable.h"
+
+/**
+ * DSP load meter of an audio callback: the time spent in each callback
+ * relative to the period of a buffer, AUDIO_DRIVER_BUFFER_SIZE / sampleRate.
+ * When the callback renders blocks longer than the buffer, only one callback
+ * every few renders a block, so the overruns are checked against the period
+ * of a block instead.
+ *
+ * The audio thread measures the callbacks with begin() and end(), while
+ * any other thread can read the instantaneous, peak and averaged load and
+ * the xrun counts, all published through lock-free atomics.
+ */
+class AudioLoadMeter {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param sampleRate sample rate of the driver
+     * @param averagingTime time constant of the averaged load, in seconds
+     */
+    explicit AudioLoadMeter(float sampleRate = AUDIO_DRIVER_SAMPLE_RATE, float averagingTime = 1.0f)
+            : averagingTime(averagingTime),
+              averageState(0.0f),
+              load(0.0f),
+              peakLoad(0.0f),
+              averageLoad(0.0f),
+              callbacks(0),
+              overruns(0),
+              xruns(0) {
+        setSampleRate(sampleRate);
+        setBlockSize(AUDIO_PROCESSOR_BLOCK_SIZE);
+    };
+
+    /**
+     * Sets the sample rate, not to be called while the callbacks are measured.
+     *
+     * @param sampleRate sample rate of the driver
+     */
+    void setSampleRate(float sampleRate) {
+        period = AUDIO_DRIVER_BUFFER_SIZE / static_cast<double>(sampleRate);
+        const double periodTicks = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(period)).count();
+        loadPerTick = static_cast<float>(1.0 / periodTicks);
+        updateSmoothing();
+    };
+
+    /**
+     * Sets the length of the blocks rendered by the callbacks,
+     * not to be called while the callbacks are measured.
+     *
+     * @param blockSize block length in samples
+     */
+    void setBlockSize(size_t blockSize) {
+        overrunLoad = (blockSize > AUDIO_DRIVER_BUFFER_SIZE)
+                      ? static_cast<float>(blockSize) / AUDIO_DRIVER_BUFFER_SIZE : 1.0f;
+    };
+
+    /**
+     * Sets the time constant of the averaged load,
+     * not to be called while the callbacks are measured.
+     *
+     * @param seconds time constant
+     */
+    void setAveragingTime(float seconds) {
+        averagingTime = seconds;
+        updateSmoothing();
+    };
+
+    /**
+     * Period of a buffer, the time available to a callback.
+     *
+     * @return seconds
+     */
+    inline double getPeriod() const { return period; };
+
+    /**
+     * Audio thread: marks the start of a callback.
+     */
+    inline void begin() { start = Clock::now(); };
+
+    /**
+     * Audio thread: marks the end of a callback and publishes its load.
+     * A callback longer than the period, or than the period of a block
+     * longer than the buffer, is counted as an overrun.
+     */
+    void end() {
+        const float newLoad = static_cast<float>((Clock::now() - start).count()) * loadPerTick;
+        averageState = (1.0f - smoothing) * averageState + smoothing * newLoad;
+
+        load.store(newLoad, std::memory_order_relaxed);
+        averageLoad.store(averageState, std::memory_order_relaxed);
+        float peak = peakLoad.load(std::memory_order_relaxed);
+        while (newLoad > peak && !peakLoad.compare_exchange_weak(peak, newLoad, std::memory_order_relaxed)) {}
+        callbacks.fetch_add(1, std::memory_order_relaxed);
+        if (newLoad > overrunLoad) overruns.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    /**
+     * Counts an xrun detected by the driver, e.g. a DMA underrun,
+     * it can be called also by an interrupt.
+     */
+    inline void reportXrun() { xruns.fetch_add(1, std::memory_order_relaxed); };
+
+    /**
+     * Load of the last callback.
+     *
+     * @return fraction of the period, greater than 1 for an overrun
+     */
+    inline float getLoad() const { return load.load(std::memory_order_relaxed); };
+
+    /**
+     * Highest load since the start or the last resetPeakLoad().
+     *
+     * @return fraction of the period
+     */
+    inline float getPeakLoad() const { return peakLoad.load(std::memory_order_relaxed); };
+
+    /**
+     * Reads and clears the peak load, e.g. at each refresh of a monitor.
+     *
+     * @return highest load since the previous reset
+     */
+    inline float resetPeakLoad() { return peakLoad.exchange(0.0f, std::memory_order_relaxed); };
+
+    /**
+     * Load averaged with an exponential moving average.
+     *
+     * @return fraction of the period
+     */
+    inline float getAverageLoad() const { return averageLoad.load(std::memory_order_relaxed); };
+
+    /**
+     * Number of measured callbacks.
+     */
+    inline uint32_t getCallbacks() const { return callbacks.load(std::memory_order_relaxed); };
+
+    /**
+     * Number of callbacks longer than the period, or than the period
+     * of a block when the blocks are longer than the buffer.
+     */
+    inline uint32_t getOverruns() const { return overruns.load(std::memory_order_relaxed); };
+
+    /**
+     * Number of xruns reported by the driver.
+     */
+    inline uint32_t getXruns() const { return xruns.load(std::memory_order_relaxed); };
+
+    AudioLoadMeter(const AudioLoadMeter &) = delete;
+
+    AudioLoadMeter &operator=(const AudioLoadMeter &) = delete;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void updateSmoothing() {
+        smoothing = (averagingTime > 0.0f) ? static_cast<float>(1.0 - std::exp(-period / averagingTime)) : 1.0f;
+    };
+
+    double period;
+    float loadPerTick;
+    float averagingTime;
+
+    /**
+     * Load above which a callback is an overrun.
+     */
+    float overrunLoad;
+
+    /**
+     * Coefficient of the moving average for each callback.
+     */
+    float smoothing;
+
+    /**
+     * Owned by the audio thread.
+     */
+    Clock::time_point start;
+    float averageState;
+
+    std::atomic<float> load;
+    std::atomic<float> peakLoad;
+    std::atomic<float> averageLoad;
+    std::atomic<uint32_t> callbacks;
+    std::atomic<uint32_t> overruns;
+    std::atomic<uint32_t> xruns;
+};
+
+/**
+ * AudioProcessable measuring the load of another one.
+ */
+class MeteredAudioProcessable : public AudioProcessable {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param processable measured processable
+     * @param loadMeter meter of the load
+     */
+    MeteredAudioProcessable(AudioProcessable &processable, AudioLoadMeter &loadMeter)
+            : processable(processable), loadMeter(loadMeter) {};
+
+    void process() override {
+        loadMeter.begin();
+        processable.process();
+        loadMeter.end();
+    };
+
+private:
+    AudioProcessable &processable;
+    AudioLoadMeter &loadMeter;
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_LOAD_METER_H
@@ -4,6 +4,10 @@
 
 #include <functional>
 #include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "audio_simd.h"
 
 namespace AudioMath {
 
@@ -17,7 +21,7 @@ namespace AudioMath {
      * @return linear interpolation between a and b based on mix
      */
      // TODO: make a template function to interpolate double and int
-    inline float linearInterpolation(float a, float b, float mix) {
+    constexpr float linearInterpolation(float a, float b, float mix) {
         return (a * (1.0f - mix)) + (b * mix);
     };
 
@@ -32,10 +36,64 @@ namespace AudioMath {
      * @param outputMax output range maximum
      * @return linear transformation of x in the output range
      */
-    inline float linearMap(float x, float inputMin, float inputMax, float outputMin, float outputMax) {
+    constexpr float linearMap(float x, float inputMin, float inputMax, float outputMin, float outputMax) {
         return (x - inputMin) / (inputMax - inputMin) * (outputMax - outputMin) + outputMin;
     }
 
+    /**
+     * Third order Lagrange interpolation between y1 and y2,
+     * using y0 and y3 as the neighbouring points.
+     * The four points are equally spaced.
+     *
+     * @param y0 point before y1
+     * @param y1 first value to interpolate
+     * @param y2 second value to interpolate
+     * @param y3 point after y2
+     * @param mix interpolation index between 0 (y1) and 1 (y2)
+     * @return interpolated value
+     */
+    constexpr float lagrangeInterpolation(float y0, float y1, float y2, float y3, float mix) {
+        const float d0 = mix + 1.0f;
+        const float d1 = mix;
+        const float d2 = mix - 1.0f;
+        const float d3 = mix - 2.0f;
+        return -y0 * (d1 * d2 * d3) * (1.0f / 6.0f)
+               + y1 * (d0 * d2 * d3) * 0.5f
+               - y2 * (d0 * d1 * d3) * 0.5f
+               + y3 * (d0 * d1 * d2) * (1.0f / 6.0f);
+    }
+
+    /**
+     * Cubic Hermite (Catmull-Rom) interpolation between y1 and y2,
+     * using y0 and y3 to estimate the slopes.
+     * The four points are equally spaced.
+     *
+     * @param y0 point before y1
+     * @param y1 first value to interpolate
+     * @param y2 second value to interpolate
+     * @param y3 point after y2
+     * @param mix interpolation index between 0 (y1) and 1 (y2)
+     * @return interpolated value
+     */
+    constexpr float hermiteInterpolation(float y0, float y1, float y2, float y3, float mix) {
+        const float c1 = 0.5f * (y2 - y0);
+        const float c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+        const float c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+        return ((c3 * mix + c2) * mix + c1) * mix + y1;
+    }
+
+    /**
+     * Returns the smallest power of two greater or equal than x.
+     *
+     * @param x input
+     * @return power of two
+     */
+    constexpr size_t nextPowerOfTwo(size_t x) {
+        size_t power = 1;
+        while (power < x) power <<= 1;
+        return power;
+    }
+
     /**
      * Clips the input in a specified range.
      *
@@ -44,12 +102,146 @@ namespace AudioMath {
      * @param max high clip bound
      * @return clipped input
      */
-    inline float clip(float x, float min, float max) {
+    constexpr float clip(float x, float min, float max) {
         x = (x < min)? min : x;
         x = (x > max)? max : x;
         return x;
     }
 
+    /**
+     * Versions of some mathematical functions that can be evaluated
+     * at compile time, to generate constexpr LookupTables.
+     * They are computed in double precision with polynomial approximations
+     * accurate to the float precision, but they are slow: in the audio
+     * thread use the LookupTables generated with them.
+     */
+    namespace Constexpr {
+        constexpr double pi = 3.14159265358979323846;
+        constexpr double ln2 = 0.69314718055994530942;
+
+        /**
+         * Sine function.
+         *
+         * @param x input in radians
+         * @return sine of x
+         */
+        constexpr float sin(float x) {
+            // reducing the argument between -pi/2 and pi/2
+            double r = x;
+            r -= 2.0 * pi * static_cast<long>(r / (2.0 * pi));
+            if (r > pi) r -= 2.0 * pi;
+            if (r < -pi) r += 2.0 * pi;
+            if (r > pi / 2.0) r = pi - r;
+            if (r < -pi / 2.0) r = -pi - r;
+
+            // Taylor series up to the 15th order
+            double term = r;
+            double sum = r;
+            for (int n = 1; n <= 7; n++) {
+                term *= -r * r / ((2.0 * n) * (2.0 * n + 1.0));
+                sum += term;
+            }
+            return static_cast<float>(sum);
+        }
+
+        /**
+         * Exponential function.
+         *
+         * @param x input
+         * @return e raised to x
+         */
+        constexpr float exp(float x) {
+            // x = n * ln2 + r, with r between -ln2/2 and ln2/2
+            const long n = static_cast<long>(x / ln2 + ((x < 0.0f) ? -0.5 : 0.5));
+            const double r = x - n * ln2;
+
+            // Taylor series of e^r up to the 12th order
+            double term = 1.0;
+            double sum = 1.0;
+            for (int k = 1; k <= 12; k++) {
+                term *= r / k;
+                sum += term;
+            }
+
+            // scaling by 2^n
+            for (long k = 0; k < n; k++) sum *= 2.0;
+            for (long k = 0; k > n; k--) sum *= 0.5;
+            return static_cast<float>(sum);
+        }
+
+        /**
+         * Hyperbolic tangent function.
+         *
+         * @param x input
+         * @return hyperbolic tangent of x
+         */
+        constexpr float tanh(float x) {
+            // tanh(x) is 1 within the float precision
+            if (x > 10.0f) return 1.0f;
+            if (x < -10.0f) return -1.0f;
+
+            const double e = Constexpr::exp(2.0f * x);
+            return static_cast<float>((e - 1.0) / (e + 1.0));
+        }
+    }
+
+    /**
+     * Function objects usable as constexpr generators of a LookupTable.
+     */
+    namespace LookupTableGenerator {
+        struct Sine {
+            constexpr float operator()(float x) const { return Constexpr::sin(x); }
+        };
+
+        struct Tanh {
+            constexpr float operator()(float x) const { return Constexpr::tanh(x); }
+        };
+    }
+
+    /**
+     * Fixed point phase that can be used to read a LookupTable.
+     * The whole 32 bit range maps to one period of the table, so an
+     * oscillator can advance the phase with an integer increment,
+     * that wraps around for free on overflow.
+     */
+    struct FixedPointPhase {
+        uint32_t value;
+
+        /**
+         * Builds a phase from a float between 0 and 1.
+         *
+         * @param phase normalized phase, it is wrapped in [0, 1)
+         * @return fixed point phase
+         */
+        static constexpr FixedPointPhase fromNormalized(float phase) {
+            // the conversion to an unsigned integer wraps the negative values
+            return FixedPointPhase{static_cast<uint32_t>(static_cast<int64_t>(
+                    (static_cast<double>(phase) - static_cast<double>(static_cast<int64_t>(phase))) * 4294967296.0))};
+        }
+
+        /**
+         * Phase increment of an oscillator.
+         *
+         * @param frequency frequency of the oscillator in Hz
+         * @param sampleRate sample frequency
+         * @return increment to add to the phase every sample
+         */
+        static constexpr uint32_t increment(float frequency, float sampleRate) {
+            return fromNormalized(frequency / sampleRate).value;
+        }
+
+        /**
+         * Advances the phase, wrapping around at the end of the period.
+         *
+         * @param step phase increment
+         * @return the phase itself
+         */
+        inline FixedPointPhase &operator+=(uint32_t step) {
+            value += step;
+            return *this;
+        }
+    };
+
     /**
      * Enumeration describing the behaviour of
      * the LUT tables outside the max and argMin extremes.
@@ -72,12 +264,90 @@ namespace AudioMath {
         PERIODIC
     };
 
+    /**
+     * Collection of structs to be passed as a template argument to LookupTable
+     * to choose the interpolation between the entries of the table.
+     *
+     * Each struct interpolates at a fraction between p[0] and p[1], reading
+     * the points from p[-1] to p[2]: the LookupTable stores guard points at
+     * both ends of the table, so that no edge check is needed.
+     * The process method reads a block of fractional positions
+     * as described in AudioSimd::tableLookup.
+     */
+    namespace LookupTableInterpolation {
+        /**
+         * Reads a block of positions one at a time.
+         */
+        template<typename Interpolation>
+        inline void processPositions(float *dst, const float *table, const float *positions,
+                                     size_t n, size_t maxIndex) {
+            for (size_t i = 0; i < n; i++) {
+                int index = static_cast<int>(positions[i]);
+                index = (index < static_cast<int>(maxIndex)) ? index : static_cast<int>(maxIndex);
+                dst[i] = Interpolation::interpolate(table + index, positions[i] - static_cast<float>(index));
+            }
+        }
+
+        /**
+         * Linear interpolation, vectorized in process.
+         */
+        struct Linear {
+            static constexpr float interpolate(const float *p, float mix) {
+                return linearInterpolation(p[0], p[1], mix);
+            }
+
+            static inline void process(float *dst, const float *table, const float *positions,
+                                       size_t n, size_t maxIndex) {
+                AudioSimd::tableLookup(dst, table, positions, n, maxIndex);
+            }
+        };
+
+        /**
+         * Cubic Hermite interpolation.
+         */
+        struct Hermite {
+            static constexpr float interpolate(const float *p, float mix) {
+                return hermiteInterpolation(p[-1], p[0], p[1], p[2], mix);
+            }
+
+            static inline void process(float *dst, const float *table, const float *positions,
+                                       size_t n, size_t maxIndex) {
+                processPositions<Hermite>(dst, table, positions, n, maxIndex);
+            }
+        };
+
+        /**
+         * Third order Lagrange interpolation over four points.
+         */
+        struct Lagrange {
+            static constexpr float interpolate(const float *p, float mix) {
+                return lagrangeInterpolation(p[-1], p[0], p[1], p[2], mix);
+            }
+
+            static inline void process(float *dst, const float *table, const float *positions,
+                                       size_t n, size_t maxIndex) {
+                processPositions<Lagrange>(dst, table, positions, n, maxIndex);
+            }
+        };
+    }
+
     /**
      * Implementation of a lookup table.
      *
+     * A LookupTable built from a generator usable in constant expressions
+     * (for example the ones in LookupTableGenerator) can be declared constexpr:
+     * its content is computed by the compiler and stored in read only memory,
+     * without any cost at startup.
+     *
+     * @code
+     * constexpr AudioMath::LookupTable<1024> sineLut(AudioMath::LookupTableGenerator::Sine(),
+     *                                                0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+     * @endcode
+     *
      * @tparam SIZE dimension of the lookup table
+     * @tparam Interpolation interpolation between the entries @see LookupTableInterpolation
      */
-    template<size_t SIZE>
+    template<size_t SIZE, typename Interpolation = LookupTableInterpolation::Linear>
     class LookupTable {
     public:
         /**
@@ -90,32 +360,24 @@ namespace AudioMath {
          */
         LookupTable(std::function<float(float)> function, float argMin, float argMax,
                     LookupTableEdges edges = LookupTableEdges::EXTENDED)
-                : argMin(argMin), argMax(argMax), edges(edges) {
-
-            float x; // input value of the function
-            for (uint32_t i = 0; i < SIZE; i++) {
-                // getting the x value through a linear interpolation
-                // between max and argMin
-                x = linearInterpolation(argMin, argMax, static_cast<float>(i) / static_cast<float>(SIZE));
-
-                // storing f(x) in the table
-                table[i] = function(x);
-            }
+                : argMin(argMin), argMax(argMax), edges(edges), table{} {
+            fill(function);
+        };
 
-            switch (edges) {
-                case LookupTableEdges::PERIODIC:
-                    // Set last position (table size is SIZE+1) equal to the first
-                    table[SIZE] = table[0];
-                    break;
-                case LookupTableEdges::EXTENDED:
-                    // Set last position equal to last (extending it)
-                    table[SIZE] = table[SIZE - 1];
-                    break;
-                case LookupTableEdges::ZEROED:
-                    // Set last position to 0 (zero padding it)
-                    table[SIZE] = 0;
-                    break;
-            }
+        /**
+         * Constructor from a function object, that can be evaluated at compile time
+         * if the function object can be called in a constant expression.
+         *
+         * @param generator it must return a float and have a float as a single parameter.
+         * @param argMin minimum argument of the function stored in the LUT
+         * @param argMax maximum argument of the function stored in the LUT
+         * @param edges behaviour of the LUT exceeding the edges (check LookupTableEdges)
+         */
+        template<typename Generator>
+        constexpr LookupTable(const Generator &generator, float argMin, float argMax,
+                              LookupTableEdges edges = LookupTableEdges::EXTENDED)
+                : argMin(argMin), argMax(argMax), edges(edges), table{} {
+            fill(generator);
         };
 
         /**
@@ -125,53 +387,198 @@ namespace AudioMath {
          * @param x input value
          * @return output value approximated using the LUT
          */
-        inline float operator()(float x) {
-            float y;
-            if ((x < argMin) | (x >= argMax)) {
+        constexpr float operator()(float x) const {
+            float y = 0;
+            // NaNs are handled as values outside the range
+            if (!((x >= argMin) & (x < argMax))) {
                 switch (edges) {
                     case LookupTableEdges::ZEROED:
                         y = 0;
                         break;
                     case LookupTableEdges::EXTENDED:
-                        y = (x < argMin) ? table[0] : table[SIZE - 1];
+                        y = (x < argMin) ? table[guard] : table[guard + SIZE - 1];
                         break;
                     case LookupTableEdges::PERIODIC:
-                        // wrapping the value to the correct range
-                        // and calling again operator()
-                        // TODO: warning on phase wrapping
-                        while (x < argMin) x += (argMax-argMin);
-                        while (x >= argMax) x -= (argMax-argMin);
-                        y = this->operator()(x);
+                        // wrapping the value to the correct range in constant time
+                        y = interpolate(wrapPhase((x - argMin) / (argMax - argMin)) * SIZE);
                         break;
                 }
             } else {
                 // Extract index as a float
-                float floatIndex = linearMap(x, argMin, argMax, 0, SIZE);
+                y = interpolate(linearMap(x, argMin, argMax, 0, SIZE));
+            }
+            return y;
+        };
+
+        /**
+         * Reads the table with a fixed point phase, that spans
+         * the range between argMin and argMax over a whole period,
+         * without any wrapping or edge check.
+         *
+         * @param phase input phase
+         * @return output value approximated using the LUT
+         */
+        constexpr float operator()(FixedPointPhase phase) const {
+            // the upper 32 bits of the product are the index,
+            // the lower ones the interpolation factor
+            const uint64_t position = static_cast<uint64_t>(phase.value) * SIZE;
+            const uint32_t index0 = static_cast<uint32_t>(position >> 32);
+            const float interpolationFactor = static_cast<float>(static_cast<uint32_t>(position)) * 2.3283064e-10f;
+            return Interpolation::interpolate(table + guard + index0, interpolationFactor);
+        };
+
+        /**
+         * Evaluates the approximated function on a block of values,
+         * with the same LookupTableEdges rule of operator().
+         * The edge behaviour is resolved once for the whole block, then the
+         * table is read with the process method of the Interpolation.
+         * The input and the output can be the same array.
+         *
+         * @param input input values
+         * @param output output values approximated using the LUT
+         * @param n number of values
+         */
+        void process(const float *input, float *output, size_t n) const {
+            const float size = static_cast<float>(SIZE);
+            const float range = argMax - argMin;
+            const float scale = size / range;
 
-                // Cast float index to the nearest integers
-                int index0 = static_cast<int>(floatIndex);
-                int index1 = index0 + 1;
+            // the output array is used to store the positions in the table
+            switch (edges) {
+                case LookupTableEdges::ZEROED:
+                    // the positions outside the table read the entry SIZE, that is 0
+                    for (size_t i = 0; i < n; i++) {
+                        const float position = (input[i] - argMin) * scale;
+                        output[i] = ((position >= 0.0f) & (position < size)) ? position : size;
+                    }
+                    break;
+                case LookupTableEdges::EXTENDED:
+                    for (size_t i = 0; i < n; i++) {
+                        float position = (input[i] - argMin) * scale;
+                        position = (position > 0.0f) ? position : 0.0f;
+                        output[i] = (position < size - 1.0f) ? position : size - 1.0f;
+                    }
+                    break;
+                case LookupTableEdges::PERIODIC:
+                    const float inverseRange = 1.0f / range;
+                    for (size_t i = 0; i < n; i++) {
+                        const float position = wrapPhase((input[i] - argMin) * inverseRange) * size;
+                        output[i] = (position < size) ? position : 0.0f;
+                    }
+                    break;
+            }
 
-                float interpolationFactor = floatIndex - index0;
-                float value0 = table[index0];
-                float value1 = table[index1];
+            Interpolation::process(output, table + guard, output, n, SIZE - 1);
+        }
 
-                y = linearInterpolation(value0, value1, interpolationFactor);
+        /**
+         * Evaluates the table on a block of fixed point phases.
+         *
+         * @param input input phases
+         * @param output output values approximated using the LUT
+         * @param n number of values
+         */
+        void process(const FixedPointPhase *input, float *output, size_t n) const {
+            for (size_t i = 0; i < n; i++) {
+                output[i] = this->operator()(input[i]);
             }
-            return y;
-        };
+        }
 
     private:
         float argMin;
         float argMax;
         LookupTableEdges edges;
-        std::array<float, SIZE + 1> table;
+
+        /**
+         * Offset of the first entry of the table.
+         */
+        static constexpr size_t guard = 1;
+
+        /**
+         * The SIZE entries of the table, preceded by one guard point
+         * and followed by two, set according to the edges.
+         */
+        float table[SIZE + 3];
+
+        /**
+         * Removes the integer part of a normalized phase in constant time.
+         * Values too large to have a fractional part, and NaNs, are mapped to 0.
+         *
+         * @param phase normalized phase
+         * @return phase in [0, 1)
+         */
+        static constexpr float wrapPhase(float phase) {
+            phase = ((phase > -8388608.0f) & (phase < 8388608.0f))
+                    ? phase - static_cast<float>(static_cast<int32_t>(phase)) : 0.0f;
+            phase = (phase < 0.0f) ? phase + 1.0f : phase;
+            return (phase < 1.0f) ? phase : 0.0f;
+        }
+
+        /**
+         * Interpolation between the entries of the
+         * table around a fractional index.
+         *
+         * @param floatIndex index between 0 and SIZE
+         * @return interpolated value
+         */
+        constexpr float interpolate(float floatIndex) const {
+            // Cast float index to the nearest integer
+            int index0 = static_cast<int>(floatIndex);
+            index0 = (index0 < static_cast<int>(SIZE)) ? index0 : static_cast<int>(SIZE) - 1;
+
+            float interpolationFactor = floatIndex - index0;
+            return Interpolation::interpolate(table + guard + index0, interpolationFactor);
+        }
+
+        /**
+         * Stores the function in the table.
+         *
+         * @param function function to sample
+         */
+        template<typename Function>
+        constexpr void fill(const Function &function) {
+            float x = 0; // input value of the function
+            for (uint32_t i = 0; i < SIZE; i++) {
+                // getting the x value through a linear interpolation
+                // between max and argMin
+                x = linearInterpolation(argMin, argMax, static_cast<float>(i) / static_cast<float>(SIZE));
+
+                // storing f(x) in the table
+                table[guard + i] = function(x);
+            }
+
+            // guard points before the first entry and after the last one
+            float *first = table + guard;
+            switch (edges) {
+                case LookupTableEdges::PERIODIC:
+                    // continuing the period on both sides
+                    first[-1] = first[SIZE - 1];
+                    first[SIZE] = first[0];
+                    first[SIZE + 1] = first[1 % SIZE];
+                    break;
+                case LookupTableEdges::EXTENDED:
+                    // extending the first and last entries
+                    first[-1] = first[0];
+                    first[SIZE] = first[SIZE - 1];
+                    first[SIZE + 1] = first[SIZE - 1];
+                    break;
+                case LookupTableEdges::ZEROED:
+                    // zero padding the table
+                    first[-1] = 0;
+                    first[SIZE] = 0;
+                    first[SIZE + 1] = 0;
+                    break;
+            }
+        }
 
         LookupTable(const LookupTable &);
 
         LookupTable &operator=(const LookupTable &);
     };
 
+    template<size_t SIZE, typename Interpolation>
+    constexpr size_t LookupTable<SIZE, Interpolation>::guard;
+
 };
 
 #endif //MIOSIX_AUDIO_AUDIO_MATH_H
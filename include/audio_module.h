@@ -33,9 +33,9 @@ public:
      * An implementation of an AudioModule must implement this
      * virtual method.
      *
-     * @param buffer AudioBuffer to be processed
+     * @param buffer AudioBuffer of AUDIO_PROCESSOR_BLOCK_SIZE samples to be processed
      */
-    virtual void process(AudioBuffer<float, CHANNEL_NUM, AUDIO_DRIVER_BUFFER_SIZE> &buffer) = 0;
+    virtual void process(AudioBuffer<float, CHANNEL_NUM, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) = 0;
 
     /**
      * Returns the sample rate of the AudioDriver used by the AudioProcessor.
@@ -4,6 +4,11 @@
 #define STM32_MONOSYNTH_AUDIO_PARAMETER_H
 
 #include "audio_math.h"
+#include "audio_buffer.h"
+#include "audio_simd.h"
+#include <array>
+#include <atomic>
+#include <cmath>
 
 /**
  * Default number of samples to pass
@@ -11,6 +16,195 @@
  */
 #define AUDIO_PARAMETER_DEFAULT_TRANSITION_SAMPLES 100
 
+/**
+ * Collection of structs to be passed as a template argument to AudioParameter
+ * to choose the law of the transition from the lastValue to the currentValue.
+ *
+ * Each struct provides:
+ * - interpolate(last, current, index), the value at a transition index between 0 and 1
+ * - render(dst, last, current, passed, total, n), writing the values of n samples
+ *   starting from the sample passed of a transition of total samples,
+ *   with n <= total - passed. It is computed with a recurrence,
+ *   without any per sample branch or call to the math library.
+ */
+namespace AudioParameterSmoothing {
+    /**
+     * Linear ramp.
+     */
+    struct Linear {
+        template<typename T>
+        static inline T interpolate(T last, T current, float index) {
+            return AudioMath::linearInterpolation(last, current, index);
+        }
+
+        template<typename T>
+        static void render(T *dst, T last, T current, size_t passed, size_t total, size_t n) {
+            const T start = interpolate(last, current, static_cast<float>(passed) / static_cast<float>(total));
+            const T step = (current - last) / static_cast<T>(total);
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = start + step * static_cast<T>(i);
+            }
+        }
+    };
+
+    /**
+     * Exponential (multiplicative) ramp, the value is multiplied by a
+     * constant ratio at each sample. It is suited for frequencies and gains,
+     * whose perception is logarithmic. When the two values do not have the
+     * same sign, or one of them is 0, it falls back to the linear ramp.
+     */
+    struct Exponential {
+        template<typename T>
+        static inline T interpolate(T last, T current, float index) {
+            if (!(last * current > 0)) return Linear::interpolate(last, current, index);
+            return last * std::pow(current / last, index);
+        }
+
+        template<typename T>
+        static void render(T *dst, T last, T current, size_t passed, size_t total, size_t n) {
+            if (!(last * current > 0)) {
+                Linear::render(dst, last, current, passed, total, n);
+                return;
+            }
+            const T ratio = std::pow(current / last, 1 / static_cast<T>(total));
+            T value = interpolate(last, current, static_cast<float>(passed) / static_cast<float>(total));
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = value;
+                value *= ratio;
+            }
+        }
+    };
+
+    /**
+     * One pole lowpass, the distance from the currentValue decays
+     * exponentially and is reduced to -60 dB at the end of the transition,
+     * when the parameter reaches the currentValue.
+     */
+    struct OnePole {
+        /**
+         * Residual distance from the currentValue at the end of the transition.
+         */
+        static constexpr float residual = 0.001f;
+
+        template<typename T>
+        static inline T interpolate(T last, T current, float index) {
+            return current + (last - current) * std::pow(static_cast<T>(residual), index);
+        }
+
+        template<typename T>
+        static void render(T *dst, T last, T current, size_t passed, size_t total, size_t n) {
+            const T decay = std::pow(static_cast<T>(residual), 1 / static_cast<T>(total));
+            T distance = interpolate(last, current, static_cast<float>(passed) / static_cast<float>(total)) - current;
+            for (size_t i = 0; i < n; i++) {
+                dst[i] = current + distance;
+                distance *= decay;
+            }
+        }
+    };
+
+    /**
+     * S-curve (smoothstep) ramp, that starts and ends with zero slope.
+     */
+    struct SCurve {
+        template<typename T>
+        static inline T interpolate(T last, T current, float index) {
+            return last + (current - last) * static_cast<T>(index * index * (3.0f - 2.0f * index));
+        }
+
+        template<typename T>
+        static void render(T *dst, T last, T current, size_t passed, size_t total, size_t n) {
+            const float step = 1.0f / static_cast<float>(total);
+            const float start = static_cast<float>(passed) * step;
+            for (size_t i = 0; i < n; i++) {
+                const float index = start + static_cast<float>(i) * step;
+                dst[i] = last + (current - last) * static_cast<T>(index * index * (3.0f - 2.0f * index));
+            }
+        }
+    };
+}
+
+/**
+ * Change of value of an AudioParameter scheduled at a certain
+ * sample of the block.
+ */
+template<typename T>
+struct AudioParameterEvent {
+    /**
+     * Sample of the block where the new value takes effect.
+     */
+    size_t offset;
+
+    /**
+     * New value of the parameter.
+     */
+    T value;
+};
+
+/**
+ * Fixed capacity list of AudioParameterEvents, sorted by offset,
+ * that does not allocate memory. It is meant to be filled and consumed
+ * by the same thread, e.g. the audio thread while parsing MIDI messages.
+ *
+ * @tparam T type of the parameter
+ * @tparam CAPACITY maximum number of events
+ */
+template<typename T, size_t CAPACITY>
+class AudioParameterEventQueue {
+public:
+    AudioParameterEventQueue() : eventNumber(0) {};
+
+    /**
+     * Schedules a new value, events with the same offset
+     * take effect in the order they are pushed.
+     *
+     * @param offset sample where the new value takes effect, it can exceed
+     * the current block to schedule the event in a following block
+     * @param value new value
+     * @return false if the queue is full and the event has been discarded
+     */
+    bool push(size_t offset, T value) {
+        if (eventNumber == CAPACITY) return false;
+
+        // insertion keeping the events sorted
+        size_t i = eventNumber;
+        for (; i > 0 && events[i - 1].offset > offset; i--) {
+            events[i] = events[i - 1];
+        }
+        events[i] = AudioParameterEvent<T>{offset, value};
+        eventNumber++;
+        return true;
+    }
+
+    /**
+     * Removes the events before the end of a block, the offsets
+     * of the remaining ones are moved to the next block.
+     *
+     * @param blockLength length of the consumed block
+     */
+    void advance(size_t blockLength) {
+        size_t consumed = 0;
+        while (consumed < eventNumber && events[consumed].offset < blockLength) consumed++;
+        for (size_t i = consumed; i < eventNumber; i++) {
+            events[i - consumed] = AudioParameterEvent<T>{events[i].offset - blockLength, events[i].value};
+        }
+        eventNumber -= consumed;
+    }
+
+    inline const AudioParameterEvent<T> &operator[](size_t i) const { return events[i]; };
+
+    inline size_t size() const { return eventNumber; };
+
+    inline bool empty() const { return eventNumber == 0; };
+
+    inline void clear() { eventNumber = 0; };
+
+    static constexpr size_t capacity() { return CAPACITY; };
+
+private:
+    std::array<AudioParameterEvent<T>, CAPACITY> events;
+    size_t eventNumber;
+};
+
 /**
  * This template class can be used as a wrapper for a parameter of
  * an AudioModule or similar classes.
@@ -18,8 +212,9 @@
  * to provide a smooth interpolation during the processing.
  *
  * @tparam T type
+ * @tparam Smoothing law of the transition @see AudioParameterSmoothing
  */
-template<typename T>
+template<typename T, typename Smoothing = AudioParameterSmoothing::Linear>
 class AudioParameter {
 public:
 
@@ -49,13 +244,14 @@ public:
 
     /**
      * Gets the interpolation between the lastValue and the currentValue
-     * scaled by the transitionIndex.
+     * scaled by the transitionIndex, following the Smoothing law.
      *
      * @return interpolated value
      */
      // TODO: interpolation works just for float values
     inline T getInterpolatedValue() const {
-        return AudioMath::linearInterpolation(lastValue, currentValue, getTransitionIndex());
+        if (transitionIsComplete()) return currentValue;
+        return Smoothing::interpolate(lastValue, currentValue, getTransitionIndex());
     };
 
     /**
@@ -93,6 +289,92 @@ public:
         }
     }
 
+    /**
+     * Writes the interpolated values of the next n samples,
+     * then advances the transition by n samples.
+     * It is equivalent to calling getInterpolatedValue() and
+     * updateSampleCount(1) for each sample, but the ramp is rendered
+     * by the Smoothing for the whole block, and once the transition
+     * is complete the block is filled with the currentValue.
+     *
+     * @param dst destination array
+     * @param n number of samples
+     */
+    void fillRamp(T *dst, size_t n) {
+        if (transitionIsComplete()) {
+            AudioSimd::fill(dst, currentValue, n);
+            return;
+        }
+
+        const size_t remainingSamples = totalTransitionSamples - passedTransitionSamples;
+        const size_t rampLength = (n < remainingSamples) ? n : remainingSamples;
+        Smoothing::render(dst, lastValue, currentValue, passedTransitionSamples, totalTransitionSamples, rampLength);
+        AudioSimd::fill(dst + rampLength, currentValue, n - rampLength);
+        updateSampleCount(n);
+    }
+
+    /**
+     * Splits a block into sub blocks at the offsets of the scheduled events,
+     * calling setValue() at the start of each sub block.
+     * The events of the block are then removed from the queue.
+     *
+     * @param events scheduled events
+     * @param n length of the block
+     * @param function callable with the offset and the length of a sub block as parameters,
+     * it must advance the transition by the length of the sub block (e.g. with fillRamp)
+     */
+    template<size_t CAPACITY, typename Function>
+    void processEvents(AudioParameterEventQueue<T, CAPACITY> &events, size_t n, Function &&function) {
+        size_t start = 0;
+        for (size_t i = 0; i < events.size() && events[i].offset < n; i++) {
+            if (events[i].offset > start) {
+                function(start, events[i].offset - start);
+                start = events[i].offset;
+            }
+            setValue(events[i].value);
+        }
+        if (start < n) {
+            function(start, n - start);
+        }
+        events.advance(n);
+    }
+
+    /**
+     * Writes the interpolated values of a block, applying
+     * the scheduled events at their exact sample.
+     *
+     * @param dst destination array
+     * @param n number of samples
+     * @param events scheduled events
+     */
+    template<size_t CAPACITY>
+    void fillRamp(T *dst, size_t n, AudioParameterEventQueue<T, CAPACITY> &events) {
+        processEvents(events, n, [this, dst](size_t offset, size_t length) { fillRamp(dst + offset, length); });
+    }
+
+    /**
+     * Multiplies each channel of an AudioBuffer by the interpolated
+     * values of the parameter, used as a smoothed gain, then advances
+     * the transition by the length of the buffer.
+     * Once the transition is complete, this is a single
+     * AudioBuffer::applyGain with the currentValue.
+     *
+     * @param buffer AudioBuffer to scale
+     */
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void applyRamp(AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) {
+        if (transitionIsComplete()) {
+            buffer.applyGain(currentValue);
+            return;
+        }
+
+        T ramp[BUFFER_LEN];
+        fillRamp(ramp, BUFFER_LEN);
+        for (size_t channelNumber = 0; channelNumber < CHANNEL_NUM; channelNumber++) {
+            AudioSimd::multiply(buffer.getWritePointer(channelNumber), ramp, BUFFER_LEN);
+        }
+    }
+
     /**
      * Setter for totalTransitionSamples. A greater value indicates
      * a longer transition.
@@ -145,4 +427,93 @@ private:
     T lastValue;
 };
 
+/**
+ * AudioParameter that can be set from a different thread than
+ * the audio one, like a UI or MIDI thread.
+ *
+ * The control thread publishes the target value with setValue(),
+ * through an atomic slot where the last value wins. The audio thread
+ * calls update() once per block to pick it up, starting a new transition
+ * of the underlying AudioParameter, that is only accessed by the audio thread.
+ *
+ * @tparam T type, it must be trivially copyable and preferably lock free as std::atomic<T>
+ * @tparam Smoothing law of the transition @see AudioParameterSmoothing
+ */
+template<typename T, typename Smoothing = AudioParameterSmoothing::Linear>
+class AtomicAudioParameter {
+public:
+
+    /**
+     * Constructor with an initializer for the parameter value.
+     *
+     * @param value
+     */
+    AtomicAudioParameter(T value) : targetValue(value), parameter(value) {};
+
+    /**
+     * Publishes a new value, it can be called by any thread.
+     *
+     * @param newValue
+     */
+    inline void setValue(T newValue) { targetValue.store(newValue, std::memory_order_release); };
+
+    /**
+     * Getter for the last published value, it can be called by any thread.
+     *
+     * @return target value
+     */
+    inline T getTargetValue() const { return targetValue.load(std::memory_order_acquire); };
+
+    /**
+     * Picks up the last published value, starting a new transition
+     * if it has changed. To be called by the audio thread, once per block.
+     */
+    inline void update() {
+        const T newValue = targetValue.load(std::memory_order_acquire);
+        if (newValue != parameter.getValue()) {
+            parameter.setValue(newValue);
+        }
+    };
+
+    /**
+     * Underlying AudioParameter, to be used only by the audio thread.
+     *
+     * @return parameter
+     */
+    inline AudioParameter<T, Smoothing> &getParameter() { return parameter; };
+
+    /**
+     * Audio thread shorthand for update() followed by AudioParameter::fillRamp.
+     *
+     * @param dst destination array
+     * @param n number of samples
+     */
+    inline void fillRamp(T *dst, size_t n) {
+        update();
+        parameter.fillRamp(dst, n);
+    };
+
+    /**
+     * Audio thread shorthand for update() followed by AudioParameter::applyRamp.
+     *
+     * @param buffer AudioBuffer to scale
+     */
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    inline void applyRamp(AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer) {
+        update();
+        parameter.applyRamp(buffer);
+    };
+
+private:
+    /**
+     * Last value published by the control thread.
+     */
+    std::atomic<T> targetValue;
+
+    /**
+     * State of the smoothing, owned by the audio thread.
+     */
+    AudioParameter<T, Smoothing> parameter;
+};
+
 #endif //STM32_MONOSYNTH_AUDIO_PARAMETER_H
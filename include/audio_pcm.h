@@ -0,0 +1,319 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_PCM_H
+#define MIOSIX_AUDIO_AUDIO_PCM_H
+
+#include <cstddef>
+#include <cstdint>
+#include "audio_simd.h"
+
+/**
+ * Conversion of planar float samples, bounded in [-1.0, 1.0],
+ * to interleaved stereo integer PCM samples.
+ *
+ * The samples are clipped, scaled to the full range of the bit depth and
+ * rounded to the nearest integer. Bit depths greater than 16 are stored
+ * in 32 bit containers, right justified (e.g. 24 bit samples range
+ * between -8388607 and 8388607).
+ */
+namespace AudioPcm {
+
+    /**
+     * Largest positive value of a signed integer with a certain bit depth,
+     * as a float that can be converted back to the integer without overflow.
+     *
+     * @param bitDepth number of bits, between 16 and 32
+     * @return maximum value
+     */
+    inline float maxValue(unsigned int bitDepth) {
+        // 2^31 - 1 is not representable as a float, the closest smaller float is used
+        return (bitDepth >= 32) ? 2147483520.0f : static_cast<float>((1u << (bitDepth - 1)) - 1);
+    }
+
+    /**
+     * Offset added before the truncation by round(): the largest float below 0.5,
+     * since adding 0.5 would round up the values just below a half.
+     */
+    constexpr float roundingOffset = 0.49999997f;
+
+    /**
+     * Rounds to the nearest integer, with the halves away from zero.
+     * Unlike std::lrint, it is inlined instead of being a library call.
+     *
+     * @param y value inside the range of int32_t
+     * @return rounded value
+     */
+    inline int32_t round(float y) {
+        return static_cast<int32_t>(y + ((y < 0.0f) ? -roundingOffset : roundingOffset));
+    }
+
+#if defined(AUDIO_SIMD_AVX2) || defined(AUDIO_SIMD_SSE2)
+    /**
+     * Vectorized round(), with the halves away from zero like the scalar one.
+     *
+     * @param y values inside the range of int32_t
+     * @return rounded values
+     */
+    inline __m128i round(__m128 y) {
+        const __m128 half = _mm_or_ps(_mm_and_ps(y, _mm_set1_ps(-0.0f)), _mm_set1_ps(roundingOffset));
+        return _mm_cvttps_epi32(_mm_add_ps(y, half));
+    }
+#elif defined(AUDIO_SIMD_NEON)
+    /**
+     * Vectorized round(), with the halves away from zero like the scalar one.
+     *
+     * @param y values inside the range of int32_t
+     * @return rounded values
+     */
+    inline int32x4_t round(float32x4_t y) {
+        const float32x4_t half = vdupq_n_f32(roundingOffset);
+        return vcvtq_s32_f32(vbslq_f32(vcltq_f32(y, vdupq_n_f32(0.0f)), vsubq_f32(y, half), vaddq_f32(y, half)));
+    }
+#endif
+
+    /**
+     * Scalar conversion of a sample.
+     *
+     * @param x sample
+     * @param scale maximum value of the bit depth
+     * @return rounded integer sample
+     */
+    inline int32_t quantize(float x, float scale) {
+        x = (x > -1.0f) ? x : -1.0f;
+        x = (x < 1.0f) ? x : 1.0f;
+        const float y = x * scale;
+        return round((y < scale) ? y : scale);
+    }
+
+    /**
+     * Converts and interleaves two channels to 16 bit samples.
+     *
+     * @param dst interleaved output, 2 * n samples
+     * @param left left channel
+     * @param right right channel
+     * @param n number of samples of each channel
+     */
+    inline void interleave(int16_t *dst, const float *left, const float *right, size_t n) {
+        const float scale = 32767.0f;
+        size_t i = 0;
+#if defined(AUDIO_SIMD_AVX2) || defined(AUDIO_SIMD_SSE2)
+        const __m128 low = _mm_set1_ps(-1.0f);
+        const __m128 high = _mm_set1_ps(1.0f);
+        const __m128 s = _mm_set1_ps(scale);
+        const size_t vectorEnd = n - (n % 8);
+        for (; i < vectorEnd; i += 8) {
+            // the pack saturates
+            const __m128i l0 = round(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i), low), high), s));
+            const __m128i l1 = round(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i + 4), low), high), s));
+            const __m128i r0 = round(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i), low), high), s));
+            const __m128i r1 = round(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i + 4), low), high), s));
+            const __m128i l = _mm_packs_epi32(l0, l1);
+            const __m128i r = _mm_packs_epi32(r0, r1);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), _mm_unpacklo_epi16(l, r));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+        }
+#elif defined(AUDIO_SIMD_NEON)
+        const float32x4_t low = vdupq_n_f32(-1.0f);
+        const float32x4_t high = vdupq_n_f32(1.0f);
+        const size_t vectorEnd = n - (n % 8);
+        for (; i < vectorEnd; i += 8) {
+            int16x8x2_t samples;
+            const float *channels[2] = {left, right};
+            for (int c = 0; c < 2; c++) {
+                const float32x4_t x0 = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(channels[c] + i), low), high), scale);
+                const float32x4_t x1 = vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(channels[c] + i + 4), low), high), scale);
+                samples.val[c] = vcombine_s16(vqmovn_s32(round(x0)), vqmovn_s32(round(x1)));
+            }
+            vst2q_s16(dst + 2 * i, samples);
+        }
+#endif
+        for (; i < n; i++) {
+            dst[2 * i] = static_cast<int16_t>(quantize(left[i], scale));
+            dst[2 * i + 1] = static_cast<int16_t>(quantize(right[i], scale));
+        }
+    }
+
+    /**
+     * Converts and interleaves two channels to samples of a certain
+     * bit depth, stored in 32 bit containers.
+     *
+     * @param dst interleaved output, 2 * n samples
+     * @param left left channel
+     * @param right right channel
+     * @param n number of samples of each channel
+     * @param bitDepth bit depth of the samples, between 16 and 32
+     */
+    inline void interleave(int32_t *dst, const float *left, const float *right, size_t n, unsigned int bitDepth) {
+        const float scale = maxValue(bitDepth);
+        size_t i = 0;
+#if defined(AUDIO_SIMD_AVX2) || defined(AUDIO_SIMD_SSE2)
+        const __m128 low = _mm_set1_ps(-1.0f);
+        const __m128 high = _mm_set1_ps(1.0f);
+        const __m128 s = _mm_set1_ps(scale);
+        const size_t vectorEnd = n - (n % 4);
+        for (; i < vectorEnd; i += 4) {
+            const __m128 l = _mm_min_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(left + i), low), high), s), s);
+            const __m128 r = _mm_min_ps(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(right + i), low), high), s), s);
+            const __m128i li = round(l);
+            const __m128i ri = round(r);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), _mm_unpacklo_epi32(li, ri));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i + 4), _mm_unpackhi_epi32(li, ri));
+        }
+#endif
+        for (; i < n; i++) {
+            dst[2 * i] = quantize(left[i], scale);
+            dst[2 * i + 1] = quantize(right[i], scale);
+        }
+    }
+}
+
+/**
+ * Dither applied by the PcmConverter before the quantization.
+ */
+enum class PcmDither {
+    /**
+     * Plain rounding, vectorized.
+     */
+    NONE,
+
+    /**
+     * Triangular probability density function dither of 1 LSB,
+     * it decorrelates the quantization error from the signal.
+     */
+    TPDF,
+
+    /**
+     * TPDF dither with first order noise shaping, that moves the
+     * quantization noise towards the high frequencies.
+     */
+    NOISE_SHAPED
+};
+
+/**
+ * Stateful converter from planar float channels to interleaved PCM,
+ * with optional dither. Without dither the AudioPcm vectorized kernels
+ * are used, while the dither is computed one sample at a time,
+ * since the noise shaping depends on the error of the previous sample.
+ */
+class PcmConverter {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param dither dither to apply
+     */
+    explicit PcmConverter(PcmDither dither = PcmDither::NONE) : dither(dither), randomState(0x12345678u) {
+        error[0] = 0.0f;
+        error[1] = 0.0f;
+    };
+
+    /**
+     * Setter for the dither.
+     *
+     * @param newDither dither to apply
+     */
+    inline void setDither(PcmDither newDither) {
+        dither = newDither;
+        error[0] = 0.0f;
+        error[1] = 0.0f;
+    };
+
+    /**
+     * Getter for the dither.
+     *
+     * @return dither
+     */
+    inline PcmDither getDither() const { return dither; };
+
+    /**
+     * Converts two channels to interleaved 16 bit samples.
+     *
+     * @param dst interleaved output, 2 * n samples
+     * @param left left channel
+     * @param right right channel
+     * @param n number of samples of each channel
+     */
+    void convert(int16_t *dst, const float *left, const float *right, size_t n) {
+        if (dither == PcmDither::NONE) {
+            AudioPcm::interleave(dst, left, right, n);
+            return;
+        }
+        const float scale = AudioPcm::maxValue(16);
+        for (size_t i = 0; i < n; i++) {
+            dst[2 * i] = static_cast<int16_t>(ditheredQuantize(left[i], scale, 0));
+            dst[2 * i + 1] = static_cast<int16_t>(ditheredQuantize(right[i], scale, 1));
+        }
+    };
+
+    /**
+     * Converts two channels to interleaved samples
+     * of a certain bit depth, in 32 bit containers.
+     *
+     * @param dst interleaved output, 2 * n samples
+     * @param left left channel
+     * @param right right channel
+     * @param n number of samples of each channel
+     * @param bitDepth bit depth of the samples, between 16 and 32
+     */
+    void convert(int32_t *dst, const float *left, const float *right, size_t n, unsigned int bitDepth) {
+        if (dither == PcmDither::NONE) {
+            AudioPcm::interleave(dst, left, right, n, bitDepth);
+            return;
+        }
+        const float scale = AudioPcm::maxValue(bitDepth);
+        for (size_t i = 0; i < n; i++) {
+            dst[2 * i] = ditheredQuantize(left[i], scale, 0);
+            dst[2 * i + 1] = ditheredQuantize(right[i], scale, 1);
+        }
+    };
+
+private:
+
+    /**
+     * Triangular random number in (-1, 1), difference of the two
+     * uniform halves of a xorshift generator output.
+     */
+    inline float triangularRandom() {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        const int32_t difference = static_cast<int32_t>(randomState & 0xFFFF) - static_cast<int32_t>(randomState >> 16);
+        return static_cast<float>(difference) * (1.0f / 65536.0f);
+    };
+
+    /**
+     * Quantizes a sample with dither.
+     *
+     * @param x sample
+     * @param scale maximum value of the bit depth
+     * @param channel channel of the sample, for the noise shaping state
+     * @return integer sample
+     */
+    inline int32_t ditheredQuantize(float x, float scale, int channel) {
+        x = (x > -1.0f) ? x : -1.0f;
+        x = (x < 1.0f) ? x : 1.0f;
+        const float target = x * scale - error[channel];
+        float y = target + triangularRandom();
+        y = (y > -scale) ? y : -scale;
+        y = (y < scale) ? y : scale;
+        const int32_t q = AudioPcm::round(y);
+        if (dither == PcmDither::NOISE_SHAPED) {
+            error[channel] = static_cast<float>(q) - target;
+        }
+        return q;
+    };
+
+    PcmDither dither;
+
+    /**
+     * State of the random generator.
+     */
+    uint32_t randomState;
+
+    /**
+     * Quantization error of the previous sample of each channel.
+     */
+    float error[2];
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_PCM_H
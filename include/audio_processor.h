@@ -27,18 +27,20 @@ public:
     virtual void process() = 0;
 
     /**
-     * Gets the output buffer from the AudioDriver.
+     * Gets the output buffer from the AudioDriver, of AUDIO_PROCESSOR_BLOCK_SIZE samples.
      *
      * @return output stereo buffer
      */
-    inline AudioBuffer<float, 2, AUDIO_DRIVER_BUFFER_SIZE> &getBuffer() const { return audioDriver.getBuffer(); };
+    inline AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &getBuffer() const {
+        return audioDriver.getProcessingBuffer();
+    };
 
     /**
      * Gets the length of the the output buffer.
      *
      * @return output buffer length
      */
-    inline unsigned int getBufferSize() const { return audioDriver.getBufferSize(); };
+    inline unsigned int getBufferSize() const { return AUDIO_PROCESSOR_BLOCK_SIZE; };
 
     /**
      * Get the sample rate of the AudioDriver.
@@ -0,0 +1,428 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_PROFILER_H
+#define MIOSIX_AUDIO_AUDIO_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "audio_config.h"
+#include "audio_buffer.h"
+#include "audio_module.h"
+#include "audio_processable.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <x86intrin.h>
+
+#elif !defined(__aarch64__) && !defined(__ARM_ARCH_7M__) && !defined(__ARM_ARCH_7EM__)
+
+#include <chrono>
+
+#endif
+
+/**
+ * Cheapest timestamp counter of the target: the TSC on x86, the virtual
+ * counter on AArch64, the DWT cycle counter on Cortex-M3/M4/M7 and
+ * a steady clock in nanoseconds elsewhere.
+ */
+namespace AudioCycleCounter {
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+    typedef uint32_t Ticks;
+#else
+    typedef uint64_t Ticks;
+#endif
+
+    /**
+     * Enables the counter, needed only on Cortex-M where
+     * the DWT cycle counter is off after the reset.
+     */
+    inline void enable() {
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        volatile uint32_t *demcr = reinterpret_cast<volatile uint32_t *>(0xE000EDFC);
+        volatile uint32_t *dwtControl = reinterpret_cast<volatile uint32_t *>(0xE0001000);
+        *demcr |= 1u << 24;     // TRCENA
+        *dwtControl |= 1u;      // CYCCNTENA
+#endif
+    };
+
+    /**
+     * Reads the counter.
+     *
+     * @return current ticks
+     */
+    inline Ticks now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#elif defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        return *reinterpret_cast<volatile uint32_t *>(0xE0001004);
+#else
+        return static_cast<Ticks>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    };
+
+    /**
+     * Ticks between two readings, saturated to 32 bits.
+     * A 32 bit counter wrapping once in between is handled.
+     *
+     * @param start first reading
+     * @param end second reading
+     * @return elapsed ticks
+     */
+    inline uint32_t elapsed(Ticks start, Ticks end) {
+        const Ticks ticks = end - start;
+        return (ticks > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(ticks);
+    };
+}
+
+/**
+ * Statistics of a profiled section, copied out of an AudioProfileSlot.
+ *
+ * The durations are in ticks of the AudioCycleCounter and the histogram
+ * has four buckets for each power of two, so that the percentiles are
+ * accurate within 25%.
+ */
+struct AudioProfileSnapshot {
+    static constexpr size_t bucketNumber = 128;
+
+    uint32_t count;
+    uint32_t minimum;
+    uint32_t maximum;
+    uint64_t total;
+    std::array<uint32_t, bucketNumber> histogram;
+
+    /**
+     * Mean duration.
+     *
+     * @return mean ticks, 0 if no duration is recorded
+     */
+    inline double getMean() const { return (count == 0) ? 0.0 : static_cast<double>(total) / count; };
+
+    /**
+     * Duration not exceeded by a fraction of the recorded ones,
+     * as the upper bound of its bucket.
+     *
+     * @param fraction between 0 and 1, e.g. 0.99 for the 99th percentile
+     * @return ticks, 0 if no duration is recorded
+     */
+    uint32_t getPercentile(float fraction) const {
+        if (count == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(static_cast<double>(fraction) * count + 0.5);
+        // the extremes are known exactly
+        if (rank <= 1) return minimum;
+        if (rank >= count) return maximum;
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < bucketNumber; bucket++) {
+            seen += histogram[bucket];
+            if (seen >= rank) {
+                const uint32_t bound = getBucketUpperBound(bucket);
+                return (bound < minimum) ? minimum : (bound > maximum) ? maximum : bound;
+            }
+        }
+        return maximum;
+    };
+
+    /**
+     * Bucket of the histogram counting a duration.
+     *
+     * @param ticks duration
+     * @return bucket index
+     */
+    static inline size_t getBucket(uint32_t ticks) {
+        if (ticks < 4) return ticks;
+        const size_t msb = mostSignificantBit(ticks);
+        return (msb - 1) * 4 + ((ticks >> (msb - 2)) & 3u);
+    };
+
+    /**
+     * Largest duration counted by a bucket.
+     *
+     * @param bucket bucket index
+     * @return ticks
+     */
+    static inline uint32_t getBucketUpperBound(size_t bucket) {
+        if (bucket < 4) return static_cast<uint32_t>(bucket);
+        const size_t msb = bucket / 4 + 1;
+        const uint64_t lower = static_cast<uint64_t>(4 + bucket % 4) << (msb - 2);
+        return static_cast<uint32_t>(lower + (uint64_t(1) << (msb - 2)) - 1);
+    };
+
+private:
+    static inline size_t mostSignificantBit(uint32_t value) {
+#if defined(__GNUC__)
+        return 31 - static_cast<size_t>(__builtin_clz(value));
+#else
+        size_t msb = 0;
+        while (value >>= 1) msb++;
+        return msb;
+#endif
+    };
+};
+
+/**
+ * Lock-free statistics of a profiled section, written by the audio
+ * thread and read by any other thread.
+ *
+ * The single writer updates the fields inside a sequence lock: it never
+ * waits, while a reader retries its copy if a record happened meanwhile.
+ * Also the reset is requested by the readers and applied by the writer.
+ * All the fields are 32 bit atomics, lock-free also on Cortex-M.
+ */
+class AudioProfileSlot {
+public:
+    AudioProfileSlot() : name(""), sequence(0), resetRequested(false) {
+        clearFields();
+    };
+
+    /**
+     * Records a duration, to be called only by the audio thread.
+     *
+     * @param ticks duration
+     */
+    void record(uint32_t ticks) {
+        const uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        if (resetRequested.load(std::memory_order_relaxed)) {
+            clearFields();
+            resetRequested.store(false, std::memory_order_relaxed);
+        }
+        const uint32_t previousCount = count.load(std::memory_order_relaxed);
+        count.store(previousCount + 1, std::memory_order_relaxed);
+        if (previousCount == 0 || ticks < minimum.load(std::memory_order_relaxed)) {
+            minimum.store(ticks, std::memory_order_relaxed);
+        }
+        if (ticks > maximum.load(std::memory_order_relaxed)) maximum.store(ticks, std::memory_order_relaxed);
+        const uint32_t low = totalLow.load(std::memory_order_relaxed);
+        totalLow.store(low + ticks, std::memory_order_relaxed);
+        if (low + ticks < low) {
+            totalHigh.store(totalHigh.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        std::atomic<uint32_t> &bucket = histogram[AudioProfileSnapshot::getBucket(ticks)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        sequence.store(s + 2, std::memory_order_release);
+    };
+
+    /**
+     * Copies the statistics, from any thread.
+     *
+     * @param snapshot destination
+     */
+    void getSnapshot(AudioProfileSnapshot &snapshot) const {
+        while (true) {
+            const uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before % 2 == 0) {
+                snapshot.count = count.load(std::memory_order_relaxed);
+                snapshot.minimum = minimum.load(std::memory_order_relaxed);
+                snapshot.maximum = maximum.load(std::memory_order_relaxed);
+                snapshot.total = (static_cast<uint64_t>(totalHigh.load(std::memory_order_relaxed)) << 32) |
+                                 totalLow.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < AudioProfileSnapshot::bucketNumber; i++) {
+                    snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) break;
+            }
+        }
+        if (resetRequested.load(std::memory_order_acquire)) {
+            // not yet applied by the writer
+            snapshot.count = snapshot.minimum = snapshot.maximum = 0;
+            snapshot.total = 0;
+            snapshot.histogram.fill(0);
+        }
+    };
+
+    /**
+     * Requests to clear the statistics at the next record, from any thread.
+     */
+    inline void reset() { resetRequested.store(true, std::memory_order_release); };
+
+    /**
+     * Name of the profiled section.
+     */
+    inline const char *getName() const { return name; };
+
+    inline void setName(const char *newName) { name = newName; };
+
+    AudioProfileSlot(const AudioProfileSlot &) = delete;
+
+    AudioProfileSlot &operator=(const AudioProfileSlot &) = delete;
+
+private:
+    void clearFields() {
+        count.store(0, std::memory_order_relaxed);
+        minimum.store(0, std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+        totalLow.store(0, std::memory_order_relaxed);
+        totalHigh.store(0, std::memory_order_relaxed);
+        for (std::atomic<uint32_t> &bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+    };
+
+    const char *name;
+
+    /**
+     * Odd while the writer is updating the fields.
+     */
+    std::atomic<uint32_t> sequence;
+    std::atomic<bool> resetRequested;
+
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> minimum;
+    std::atomic<uint32_t> maximum;
+    std::atomic<uint32_t> totalLow;
+    std::atomic<uint32_t> totalHigh;
+    std::array<std::atomic<uint32_t>, AudioProfileSnapshot::bucketNumber> histogram;
+};
+
+/**
+ * Fixed set of profiled sections, e.g. one for each AudioModule
+ * and one for the AudioProcessor.
+ *
+ * The slots are added during the setup, then the audio thread
+ * records into them and a monitoring thread reads their snapshots.
+ *
+ * @tparam MAX_SLOTS maximum number of profiled sections
+ */
+template<size_t MAX_SLOTS = 32>
+class AudioProfiler {
+public:
+    AudioProfiler() : slotNumber(0) {};
+
+    /**
+     * Adds a profiled section, not to be called while profiling.
+     *
+     * @param name name of the section, it must outlive the profiler
+     * @return slot of the section, nullptr if MAX_SLOTS sections are already added
+     */
+    AudioProfileSlot *add(const char *name) {
+        if (slotNumber == MAX_SLOTS) return nullptr;
+        AudioProfileSlot &slot = slots[slotNumber++];
+        slot.setName(name);
+        return &slot;
+    };
+
+    /**
+     * Getter for a section.
+     *
+     * @param index position of the section, in order of addition
+     * @return slot
+     */
+    inline AudioProfileSlot &getSlot(size_t index) { return slots[index]; };
+
+    /**
+     * Number of sections added.
+     */
+    inline size_t size() const { return slotNumber; };
+
+    /**
+     * Requests to clear the statistics of all the sections.
+     */
+    void reset() {
+        for (size_t i = 0; i < slotNumber; i++) slots[i].reset();
+    };
+
+    AudioProfiler(const AudioProfiler &) = delete;
+
+    AudioProfiler &operator=(const AudioProfiler &) = delete;
+
+private:
+    std::array<AudioProfileSlot, MAX_SLOTS> slots;
+    size_t slotNumber;
+};
+
+/**
+ * Records the duration of its lifetime into a slot,
+ * it does nothing if AUDIO_PROFILING is 0 or the slot is nullptr.
+ */
+class AudioProfileScope {
+public:
+#if AUDIO_PROFILING
+
+    explicit AudioProfileScope(AudioProfileSlot *slot) : slot(slot), start(AudioCycleCounter::now()) {};
+
+    ~AudioProfileScope() {
+        const AudioCycleCounter::Ticks end = AudioCycleCounter::now();
+        if (slot != nullptr) slot->record(AudioCycleCounter::elapsed(start, end));
+    };
+
+private:
+    AudioProfileSlot *slot;
+    AudioCycleCounter::Ticks start;
+
+#else
+
+    explicit AudioProfileScope(AudioProfileSlot *) {};
+
+#endif
+
+public:
+    AudioProfileScope(const AudioProfileScope &) = delete;
+
+    AudioProfileScope &operator=(const AudioProfileScope &) = delete;
+};
+
+/**
+ * AudioModule timing another module, it can replace it
+ * e.g. inside an AudioGraph or a StaticChain.
+ *
+ * @tparam CHANNEL_NUM number of channels of the module
+ */
+template<size_t CHANNEL_NUM>
+class ProfiledAudioModule : public AudioModule<CHANNEL_NUM> {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param audioProcessor processor using the module
+     * @param module profiled module
+     * @param slot where the durations are recorded
+     */
+    ProfiledAudioModule(AudioProcessor &audioProcessor, AudioModule<CHANNEL_NUM> &module, AudioProfileSlot *slot)
+            : AudioModule<CHANNEL_NUM>(audioProcessor), module(module), slot(slot) {};
+
+    void process(AudioBuffer<float, CHANNEL_NUM, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+        AudioProfileScope scope(slot);
+        module.process(buffer);
+    };
+
+private:
+    AudioModule<CHANNEL_NUM> &module;
+    AudioProfileSlot *slot;
+};
+
+/**
+ * AudioProcessable timing another one, e.g. to profile
+ * the whole AudioProcessor when set into the AudioDriver.
+ */
+class ProfiledAudioProcessable : public AudioProcessable {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param processable profiled processable
+     * @param slot where the durations are recorded
+     */
+    ProfiledAudioProcessable(AudioProcessable &processable, AudioProfileSlot *slot)
+            : processable(processable), slot(slot) {};
+
+    void process() override {
+        AudioProfileScope scope(slot);
+        processable.process();
+    };
+
+private:
+    AudioProcessable &processable;
+    AudioProfileSlot *slot;
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_PROFILER_H
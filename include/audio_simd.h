@@ -0,0 +1,338 @@
+
+#ifndef MIOSIX_AUDIO_AUDIO_SIMD_H
+#define MIOSIX_AUDIO_AUDIO_SIMD_H
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * Selection of the SIMD backend used by the AudioSimd kernels.
+ * The backend is chosen at compile time from the instruction sets
+ * enabled in the compiler, define AUDIO_SIMD_FORCE_SCALAR to
+ * always use the plain scalar loops.
+ */
+#if defined(AUDIO_SIMD_FORCE_SCALAR)
+#define AUDIO_SIMD_SCALAR
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define AUDIO_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIO_SIMD_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIO_SIMD_NEON
+#else
+#define AUDIO_SIMD_SCALAR
+#endif
+
+/**
+ * Collection of element wise kernels operating on raw arrays,
+ * used by AudioBuffer and by the other dsp utilities of the framework.
+ *
+ * The generic templates are plain scalar loops, while the float
+ * overloads are vectorized with the backend selected at compile time.
+ */
+namespace AudioSimd {
+
+    namespace Detail {
+#if defined(AUDIO_SIMD_AVX2)
+        typedef __m256 Vector;
+        constexpr size_t width = 8;
+
+        inline Vector load(const float *p) { return _mm256_loadu_ps(p); }
+
+        inline void store(float *p, Vector v) { _mm256_storeu_ps(p, v); }
+
+        inline Vector broadcast(float x) { return _mm256_set1_ps(x); }
+
+        inline Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+
+        inline Vector subtract(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+
+        inline Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+
+#if defined(__FMA__)
+        inline Vector multiplyAdd(Vector acc, Vector a, Vector b) { return _mm256_fmadd_ps(a, b, acc); }
+#else
+        inline Vector multiplyAdd(Vector acc, Vector a, Vector b) { return _mm256_add_ps(acc, _mm256_mul_ps(a, b)); }
+#endif
+
+#elif defined(AUDIO_SIMD_SSE2)
+        typedef __m128 Vector;
+        constexpr size_t width = 4;
+
+        inline Vector load(const float *p) { return _mm_loadu_ps(p); }
+
+        inline void store(float *p, Vector v) { _mm_storeu_ps(p, v); }
+
+        inline Vector broadcast(float x) { return _mm_set1_ps(x); }
+
+        inline Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+
+        inline Vector subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+
+        inline Vector multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+
+        inline Vector multiplyAdd(Vector acc, Vector a, Vector b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+
+#elif defined(AUDIO_SIMD_NEON)
+        typedef float32x4_t Vector;
+        constexpr size_t width = 4;
+
+        inline Vector load(const float *p) { return vld1q_f32(p); }
+
+        inline void store(float *p, Vector v) { vst1q_f32(p, v); }
+
+        inline Vector broadcast(float x) { return vdupq_n_f32(x); }
+
+        inline Vector add(Vector a, Vector b) { return vaddq_f32(a, b); }
+
+        inline Vector subtract(Vector a, Vector b) { return vsubq_f32(a, b); }
+
+        inline Vector multiply(Vector a, Vector b) { return vmulq_f32(a, b); }
+
+        inline Vector multiplyAdd(Vector acc, Vector a, Vector b) { return vmlaq_f32(acc, a, b); }
+
+#endif
+    }
+
+    /**
+     * Name of the backend in use, useful for logging and benchmarks.
+     */
+#if defined(AUDIO_SIMD_AVX2)
+    constexpr const char *backendName = "AVX2";
+#elif defined(AUDIO_SIMD_SSE2)
+    constexpr const char *backendName = "SSE2";
+#elif defined(AUDIO_SIMD_NEON)
+    constexpr const char *backendName = "NEON";
+#else
+    constexpr const char *backendName = "scalar";
+#endif
+
+    /**
+     * Fills an array with a constant value.
+     *
+     * @param dst destination array
+     * @param value value to write
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void fill(T *dst, T value, size_t n) {
+        std::fill(dst, dst + n, value);
+    }
+
+    /**
+     * Copies an array into another, the two arrays must not overlap.
+     *
+     * @param dst destination array
+     * @param src source array
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void copy(T *dst, const T *src, size_t n) {
+        std::copy(src, src + n, dst);
+    }
+
+    /**
+     * Multiplies each element of an array by a constant gain.
+     * dst[i] = dst[i] * gain
+     *
+     * @param dst array to scale
+     * @param gain multiplicative factor
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void gain(T *dst, float gain, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] *= gain;
+        }
+    }
+
+    /**
+     * Element wise sum.
+     * dst[i] = dst[i] + src[i]
+     *
+     * @param dst accumulating array
+     * @param src array to sum
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void add(T *dst, const T *src, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] += src[i];
+        }
+    }
+
+    /**
+     * Element wise multiplication.
+     * dst[i] = dst[i] * src[i]
+     *
+     * @param dst array to multiply
+     * @param src multiplying array
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void multiply(T *dst, const T *src, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] *= src[i];
+        }
+    }
+
+    /**
+     * Fused multiply and accumulate.
+     * dst[i] = dst[i] + a[i] * b[i]
+     *
+     * @param dst accumulating array
+     * @param a first factor
+     * @param b second factor
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void multiplyAdd(T *dst, const T *a, const T *b, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] += a[i] * b[i];
+        }
+    }
+
+    /**
+     * Fused gain and accumulate.
+     * dst[i] = dst[i] + src[i] * gain
+     *
+     * @param dst accumulating array
+     * @param src array to scale and sum
+     * @param gain multiplicative factor applied to src
+     * @param n number of elements
+     */
+    template<typename T>
+    inline void gainAdd(T *dst, const T *src, float gain, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] += src[i] * gain;
+        }
+    }
+
+#if !defined(AUDIO_SIMD_SCALAR)
+
+    inline void gain(float *dst, float gain, size_t n) {
+        const Detail::Vector g = Detail::broadcast(gain);
+        const size_t vectorEnd = n - (n % Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += Detail::width) {
+            Detail::store(dst + i, Detail::multiply(Detail::load(dst + i), g));
+        }
+        for (; i < n; i++) {
+            dst[i] *= gain;
+        }
+    }
+
+    inline void add(float *dst, const float *src, size_t n) {
+        const size_t vectorEnd = n - (n % Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += Detail::width) {
+            Detail::store(dst + i, Detail::add(Detail::load(dst + i), Detail::load(src + i)));
+        }
+        for (; i < n; i++) {
+            dst[i] += src[i];
+        }
+    }
+
+    inline void multiply(float *dst, const float *src, size_t n) {
+        const size_t vectorEnd = n - (n % Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += Detail::width) {
+            Detail::store(dst + i, Detail::multiply(Detail::load(dst + i), Detail::load(src + i)));
+        }
+        for (; i < n; i++) {
+            dst[i] *= src[i];
+        }
+    }
+
+    inline void multiplyAdd(float *dst, const float *a, const float *b, size_t n) {
+        const size_t vectorEnd = n - (n % Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += Detail::width) {
+            Detail::store(dst + i, Detail::multiplyAdd(Detail::load(dst + i), Detail::load(a + i), Detail::load(b + i)));
+        }
+        for (; i < n; i++) {
+            dst[i] += a[i] * b[i];
+        }
+    }
+
+    inline void gainAdd(float *dst, const float *src, float gain, size_t n) {
+        const Detail::Vector g = Detail::broadcast(gain);
+        const size_t vectorEnd = n - (n % Detail::width);
+        size_t i = 0;
+        for (; i < vectorEnd; i += Detail::width) {
+            Detail::store(dst + i, Detail::multiplyAdd(Detail::load(dst + i), Detail::load(src + i), g));
+        }
+        for (; i < n; i++) {
+            dst[i] += src[i] * gain;
+        }
+    }
+
+#endif
+
+    /**
+     * Reads a table at fractional positions, with linear interpolation.
+     * dst[i] = table[k] * (1 - f) + table[k + 1] * f
+     * where k is the integer part of positions[i], limited to maxIndex,
+     * and f = positions[i] - k.
+     * The positions must not be negative and table must contain
+     * maxIndex + 2 elements. dst and positions can be the same array.
+     *
+     * The AVX2 backend uses the gather instructions, SSE2 and NEON
+     * compute the indices and the interpolation with vectors, but
+     * read the table one element at a time.
+     *
+     * @param dst destination array
+     * @param table table to read
+     * @param positions fractional positions in the table
+     * @param n number of elements
+     * @param maxIndex last index that can be used as k
+     */
+    inline void tableLookup(float *dst, const float *table, const float *positions, size_t n, size_t maxIndex) {
+        size_t i = 0;
+#if !defined(AUDIO_SIMD_SCALAR)
+        const Detail::Vector last = Detail::broadcast(static_cast<float>(maxIndex));
+        const Detail::Vector one = Detail::broadcast(1.0f);
+        const size_t vectorEnd = n - (n % Detail::width);
+        for (; i < vectorEnd; i += Detail::width) {
+            const Detail::Vector position = Detail::load(positions + i);
+#if defined(AUDIO_SIMD_AVX2)
+            const __m256i index = _mm256_cvttps_epi32(_mm256_min_ps(position, last));
+            const Detail::Vector fraction = Detail::subtract(position, _mm256_cvtepi32_ps(index));
+            const Detail::Vector value0 = _mm256_i32gather_ps(table, index, sizeof(float));
+            const Detail::Vector value1 = _mm256_i32gather_ps(table + 1, index, sizeof(float));
+#elif defined(AUDIO_SIMD_SSE2)
+            const __m128i index = _mm_cvttps_epi32(_mm_min_ps(position, last));
+            const Detail::Vector fraction = Detail::subtract(position, _mm_cvtepi32_ps(index));
+            alignas(16) int k[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(k), index);
+            const Detail::Vector value0 = _mm_setr_ps(table[k[0]], table[k[1]], table[k[2]], table[k[3]]);
+            const Detail::Vector value1 = _mm_setr_ps(table[k[0] + 1], table[k[1] + 1],
+                                                      table[k[2] + 1], table[k[3] + 1]);
+#elif defined(AUDIO_SIMD_NEON)
+            const int32x4_t index = vcvtq_s32_f32(vminq_f32(position, last));
+            const Detail::Vector fraction = Detail::subtract(position, vcvtq_f32_s32(index));
+            int k[4];
+            vst1q_s32(k, index);
+            const float values0[4] = {table[k[0]], table[k[1]], table[k[2]], table[k[3]]};
+            const float values1[4] = {table[k[0] + 1], table[k[1] + 1], table[k[2] + 1], table[k[3] + 1]};
+            const Detail::Vector value0 = Detail::load(values0);
+            const Detail::Vector value1 = Detail::load(values1);
+#endif
+            Detail::store(dst + i, Detail::add(Detail::multiply(value0, Detail::subtract(one, fraction)),
+                                               Detail::multiply(value1, fraction)));
+        }
+#endif
+        for (; i < n; i++) {
+            int index = static_cast<int>(positions[i]);
+            index = (index < static_cast<int>(maxIndex)) ? index : static_cast<int>(maxIndex);
+            const float fraction = positions[i] - static_cast<float>(index);
+            dst[i] = table[index] * (1.0f - fraction) + table[index + 1] * fraction;
+        }
+    }
+
+};
+
+#endif //MIOSIX_AUDIO_AUDIO_SIMD_H
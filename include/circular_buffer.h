@@ -1,7 +1,19 @@
 #ifndef MIOSIX_AUDIO_CIRCULAR_BUFFER_H
 #define MIOSIX_AUDIO_CIRCULAR_BUFFER_H
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <iterator>
+#include <type_traits>
+
+/**
+ * Size of a cache line, used to keep the indices of the
+ * lock-free CircularBuffer on separate cache lines.
+ */
+#ifndef CIRCULAR_BUFFER_CACHE_LINE_SIZE
+#define CIRCULAR_BUFFER_CACHE_LINE_SIZE 64
+#endif
 
 
 /**
@@ -19,9 +31,166 @@ namespace CircularBufferType
      * When adding an element to a full CircularBuffer, overwrite the head
      */
     struct Overwrite {};
+
+    /**
+     * Lock-free single producer single consumer CircularBuffer,
+     * when adding an element to a full CircularBuffer, discard it.
+     * One thread can push while another one pops, without any mutex.
+     */
+    struct SPSC {};
 }
 
 
+/**
+ * Collection of structs to be passed as a template argument to CircularBuffer
+ * to choose how the logical indices are wrapped into the underlying buffer.
+ * The head and tail indices of the buffer are counters handled by these policies,
+ * their difference is the number of elements contained by the buffer.
+ */
+namespace CircularBufferIndexing
+{
+    /**
+     * Indexing working for any buffer size: the counters run in [0, 2 * BufferSize)
+     * and are wrapped with a comparison, without any division.
+     */
+    template<size_t BufferSize>
+    struct Generic
+    {
+        /**
+         * Advances a counter by count positions, count must be at most BufferSize
+         */
+        static inline size_t advance(size_t index, size_t count)
+        {
+            index += count;
+            return (index >= 2 * BufferSize) ? index - 2 * BufferSize : index;
+        }
+
+        /**
+         * Moves a counter back by one position
+         */
+        static inline size_t previous(size_t index)
+        {
+            return (index == 0) ? 2 * BufferSize - 1 : index - 1;
+        }
+
+        /**
+         * Number of elements between two counters
+         */
+        static inline size_t distance(size_t head, size_t tail)
+        {
+            return (tail >= head) ? tail - head : tail + 2 * BufferSize - head;
+        }
+
+        /**
+         * Position of a counter in the underlying buffer
+         */
+        static inline size_t position(size_t index)
+        {
+            return (index >= BufferSize) ? index - BufferSize : index;
+        }
+    };
+
+    /**
+     * Indexing for buffer sizes that are a power of two: the counters are free running
+     * and wrapped with a bitmask, their overflow is harmless since the size of
+     * the counters is a multiple of BufferSize.
+     */
+    template<size_t BufferSize>
+    struct PowerOfTwo
+    {
+        static_assert(BufferSize != 0 && (BufferSize & (BufferSize - 1)) == 0,
+                      "PowerOfTwo indexing requires a BufferSize that is a power of two");
+
+        static inline size_t advance(size_t index, size_t count)
+        {
+            return index + count;
+        }
+
+        static inline size_t previous(size_t index)
+        {
+            return index - 1;
+        }
+
+        static inline size_t distance(size_t head, size_t tail)
+        {
+            return tail - head;
+        }
+
+        static inline size_t position(size_t index)
+        {
+            return index & (BufferSize - 1);
+        }
+    };
+
+    /**
+     * Indexing chosen at compile time, PowerOfTwo when possible, Generic otherwise
+     */
+    template<size_t BufferSize>
+    using Default = typename std::conditional<BufferSize != 0 && (BufferSize & (BufferSize - 1)) == 0,
+            PowerOfTwo<BufferSize>, Generic<BufferSize>>::type;
+}
+
+
+
+/**
+ * Contiguous region of the memory of a CircularBuffer
+ *
+ * @tparam T type of the elements, const for read only regions
+ */
+template<typename T>
+struct CircularBufferSpan
+{
+    /**
+     * Pointer to the first element of the region
+     */
+    T *data;
+
+    /**
+     * Number of elements of the region
+     */
+    size_t size;
+};
+
+/**
+ * A sequence of elements of a CircularBuffer, split in at most two contiguous
+ * regions at the wrap point of the underlying buffer. The second region is
+ * empty when the sequence does not wrap.
+ *
+ * @tparam T type of the elements, const for read only regions
+ */
+template<typename T>
+struct CircularBufferRegions
+{
+    CircularBufferSpan<T> first;
+    CircularBufferSpan<T> second;
+
+    /**
+     * Total number of elements of the two regions
+     *
+     * @return Number of elements
+     */
+    inline size_t size() const
+    {
+        return first.size + second.size;
+    }
+
+    /**
+     * Builds the regions of count elements starting from a position
+     * of an underlying buffer
+     *
+     * @param data underlying buffer
+     * @param capacity length of the underlying buffer
+     * @param position position of the first element
+     * @param count number of elements, at most capacity
+     * @return the regions
+     */
+    static inline CircularBufferRegions wrap(T *data, size_t capacity, size_t position, size_t count)
+    {
+        const size_t firstSize = (count < capacity - position) ? count : capacity - position;
+        return CircularBufferRegions{{data + position, firstSize}, {data, count - firstSize}};
+    }
+};
+
 
 /**
  * Iterator used by CircularBuffer
@@ -112,8 +281,10 @@ private:
  * @tparam T  Type to be used in the collection
  * @tparam BufferSize Max Buffer size of the circular buffer
  * @tparam OverflowPolicy Defaults to overwrite behaviour @see CircularBufferType for more options
+ * @tparam Indexing Defaults to bitmask wrapping for power of two sizes @see CircularBufferIndexing
  */
-template<typename T, size_t BufferSize, typename OverflowPolicy = CircularBufferType::Overwrite>
+template<typename T, size_t BufferSize, typename OverflowPolicy = CircularBufferType::Overwrite,
+        typename Indexing = CircularBufferIndexing::Default<BufferSize>>
 class CircularBuffer
 {
 public:
@@ -128,7 +299,7 @@ public:
     /**
      * Constructor
      */
-    CircularBuffer() : _head(1), _tail(0), _size(0) {}
+    CircularBuffer() : _head(0), _tail(0) {}
 
 
     /**
@@ -138,7 +309,7 @@ public:
      */
     inline const ReferenceType front()
     {
-        return _buffer[_head];
+        return _buffer[Indexing::position(_head)];
     }
 
     /**
@@ -148,7 +319,7 @@ public:
      */
     inline const ReferenceType back()
     {
-        return _buffer[_tail];
+        return _buffer[Indexing::position(Indexing::previous(_tail))];
     }
 
     /**
@@ -156,8 +327,7 @@ public:
      */
     inline void clear()
     {
-        _head = 1;
-        _tail = _size = 0;
+        _head = _tail = 0;
     }
 
     /**
@@ -167,7 +337,7 @@ public:
      */
     inline size_type size() const
     {
-        return _size;
+        return Indexing::distance(_head, _tail);
     }
 
     /**
@@ -187,7 +357,7 @@ public:
      */
     inline bool empty() const
     {
-        return _size == 0;
+        return _head == _tail;
     }
 
     /**
@@ -202,12 +372,12 @@ public:
     typename std::enable_if<std::is_same<Q, CircularBufferType::Overwrite>::value, void>::type
     push(ValueType item)
     {
-        if (_size == BufferSize)
+        if (size() == BufferSize)
         {
             pop();
         }
-        advance_tail();
-        _buffer[_tail] = item;
+        _buffer[Indexing::position(_tail)] = item;
+        _tail = Indexing::advance(_tail, 1);
     }
 
     /**
@@ -222,12 +392,12 @@ public:
     typename std::enable_if<std::is_same<Q, CircularBufferType::Discard>::value, void>::type
     push(ValueType item)
     {
-        if (_size == BufferSize)
+        if (size() == BufferSize)
         {
             return;
         }
-        advance_tail();
-        _buffer[_tail] = item;
+        _buffer[Indexing::position(_tail)] = item;
+        _tail = Indexing::advance(_tail, 1);
     }
 
     /**
@@ -235,12 +405,105 @@ public:
      */
     void pop()
     {
-        if (_size == 0) return;
+        if (empty()) return;
 
-        ++_head;
-        --_size;
-        if (_head == BufferSize)
-            _head = 0;
+        _head = Indexing::advance(_head, 1);
+    }
+
+    /**
+     * Returns the free slots of the buffer, up to count elements, as at most
+     * two contiguous regions that can be filled directly.
+     * The elements become part of the buffer after calling commit_write().
+     *
+     * @param count maximum number of slots requested
+     * @return regions of free slots
+     */
+    CircularBufferRegions<T> prepare_write(size_type count)
+    {
+        const size_type available = BufferSize - size();
+        if (count > available) count = available;
+        return CircularBufferRegions<T>::wrap(_buffer.data(), BufferSize, Indexing::position(_tail), count);
+    }
+
+    /**
+     * Appends to the buffer count elements written in the regions
+     * returned by prepare_write().
+     *
+     * @param count number of elements written, at most the size of the prepared regions
+     */
+    void commit_write(size_type count)
+    {
+        _tail = Indexing::advance(_tail, count);
+    }
+
+    /**
+     * Returns up to count elements from the front of the buffer, as at most
+     * two contiguous regions that can be read directly.
+     * The elements are removed from the buffer after calling commit_read().
+     *
+     * @param count maximum number of elements requested
+     * @return regions of readable elements
+     */
+    CircularBufferRegions<const T> prepare_read(size_type count) const
+    {
+        if (count > size()) count = size();
+        return CircularBufferRegions<const T>::wrap(_buffer.data(), BufferSize, Indexing::position(_head), count);
+    }
+
+    /**
+     * Removes count elements from the front of the buffer.
+     *
+     * @param count number of elements to remove
+     */
+    void commit_read(size_type count)
+    {
+        if (count > size()) count = size();
+        _head = Indexing::advance(_head, count);
+    }
+
+    /**
+     * Pushes a block of elements in the buffer, with at most two copies.
+     * On overflow, the overflow policy is applied as if the elements
+     * were pushed one at a time.
+     *
+     * @param items elements to push
+     * @param count number of elements
+     * @return number of elements added to the buffer
+     */
+    size_type write(const T *items, size_type count)
+    {
+        if (std::is_same<OverflowPolicy, CircularBufferType::Overwrite>::value)
+        {
+            // only the newest BufferSize elements can survive
+            if (count > BufferSize)
+            {
+                items += count - BufferSize;
+                count = BufferSize;
+            }
+            if (count > BufferSize - size()) commit_read(count - (BufferSize - size()));
+        }
+
+        CircularBufferRegions<T> regions = prepare_write(count);
+        std::copy(items, items + regions.first.size, regions.first.data);
+        std::copy(items + regions.first.size, items + regions.size(), regions.second.data);
+        commit_write(regions.size());
+        return regions.size();
+    }
+
+    /**
+     * Pops a block of elements from the buffer, with at most two copies.
+     *
+     * @param items destination of the elements
+     * @param count maximum number of elements
+     * @return number of elements read
+     */
+    size_type read(T *items, size_type count)
+    {
+        CircularBufferRegions<const T> regions = prepare_read(count);
+        std::copy(regions.first.data, regions.first.data + regions.first.size, items);
+        std::copy(regions.second.data, regions.second.data + regions.second.size, items + regions.first.size);
+        commit_read(regions.size());
+        return regions.size();
     }
 
 
@@ -267,31 +530,27 @@ public:
      */
     const_iterator end()
     {
-        return const_iterator(this, _size);
+        return const_iterator(this, size());
     }
 
-private:
     /**
-     * Auxiliary method to advance the tail and size pointers,
-     * usually used to add new items to the buffer
-     */
-    void advance_tail()
+    * Random access operator, undefined behaviour if index is out of bounds
+    * @param index Logical index of the chosen element, 0 is the front
+    * @return Element at logical position index
+    */
+    const ReferenceType operator[](size_type index)
     {
-        ++_tail;
-        ++_size;
-        if (_tail == BufferSize)
-            _tail = 0;
+        return _buffer[Indexing::position(Indexing::advance(_head, index))];
     }
 
     /**
-    * Auxiliary random access operator, undefined behaviour if index is out of bounds
-    * @param index Logical index of the chosen element
-    * @return Element at logical position index
+    * Random access operator, undefined behaviour if index is out of bounds
+    * @param index Logical index of the chosen element, 0 is the front
+    * @return Element at logical position index as const
     */
-    const ReferenceType operator[](size_type index)
+    const T &operator[](size_type index) const
     {
-        size_type i = (_head + index) % BufferSize;
-        return _buffer[i];
+        return _buffer[Indexing::position(Indexing::advance(_head, index))];
     }
 
 private:
@@ -301,19 +560,274 @@ private:
     std::array<T, BufferSize> _buffer;
 
     /**
-     * Head position
+     * Head counter, pointing to the first element
      */
     size_t _head;
 
     /**
-     * Tail position
+     * Tail counter, pointing past the last element
      */
     size_t _tail;
 
+};
+
+
+/**
+ * Lock-free single producer single consumer specialization of CircularBuffer,
+ * to be used to exchange data between a control thread and the audio callback.
+ *
+ * The producer thread can only call push(), the consumer thread can only call
+ * front(), pop() and clear(); size() and empty() can be called by both threads.
+ * The head and tail indices are atomics living on separate cache lines, each
+ * one written by a single thread and published with release/acquire ordering.
+ * The indices are counters wrapped by the Indexing policy, so that a full buffer
+ * can be distinguished from an empty one without any shared counter.
+ *
+ * @tparam T  Type to be used in the collection
+ * @tparam BufferSize Max Buffer size of the circular buffer
+ * @tparam Indexing Defaults to bitmask wrapping for power of two sizes @see CircularBufferIndexing
+ */
+template<typename T, size_t BufferSize, typename Indexing>
+class CircularBuffer<T, BufferSize, CircularBufferType::SPSC, Indexing>
+{
+public:
+    using ValueType = T;
+    using PointerType = T*;
+    using ReferenceType = T&;
+
+    typedef size_t      size_type;
+    typedef ptrdiff_t    difference_type;
+
+public:
+    /**
+     * Constructor
+     */
+    CircularBuffer() : _head(0), _cachedTail(0), _tail(0), _cachedHead(0) {}
+
+    /**
+     * Function to get the first element of the CircularBuffer as const,
+     * must be called only by the consumer on a non empty buffer
+     *
+     * @return First element as const
+     */
+    inline const ReferenceType front()
+    {
+        return _buffer[Indexing::position(_head.load(std::memory_order_relaxed))];
+    }
+
+    /**
+     * Removes all the elements from the buffer,
+     * must be called only by the consumer
+     */
+    inline void clear()
+    {
+        _cachedTail = _tail.load(std::memory_order_acquire);
+        _head.store(_cachedTail, std::memory_order_release);
+    }
+
+    /**
+     * Get the actual number of elements contained by the buffer,
+     * the value can be already outdated when returned
+     *
+     * @return Number of elements in the buffer
+     */
+    inline size_type size() const
+    {
+        size_type head = _head.load(std::memory_order_acquire);
+        size_type tail = _tail.load(std::memory_order_acquire);
+        return Indexing::distance(head, tail);
+    }
+
+    /**
+     * Maximum number of elements that can be contained by the CircularBuffer
+     *
+     * @return Maximum number of elements
+     */
+    inline size_type max_size() const
+    {
+        return BufferSize;
+    }
+
+    /**
+     * Checks if the buffer is empty.
+     *
+     * @return true if the buffer is empty
+     */
+    inline bool empty() const
+    {
+        return size() == 0;
+    }
+
+    /**
+     * Pushes a new element in the buffer, must be called only by the producer.
+     * If the buffer is full the new element is discarded.
+     *
+     * @param item new element
+     * @return true if the element was added
+     */
+    bool push(ValueType item)
+    {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        if (Indexing::distance(_cachedHead, tail) == BufferSize)
+        {
+            // refreshing the consumer index only when the buffer seems full
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (Indexing::distance(_cachedHead, tail) == BufferSize) return false;
+        }
+        _buffer[Indexing::position(tail)] = item;
+        _tail.store(Indexing::advance(tail, 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the front element from the buffer,
+     * must be called only by the consumer
+     *
+     * @return true if an element was removed
+     */
+    bool pop()
+    {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail)
+        {
+            // refreshing the producer index only when the buffer seems empty
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail) return false;
+        }
+        _head.store(Indexing::advance(head, 1), std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Returns the free slots of the buffer, up to count elements, as at most
+     * two contiguous regions that can be filled directly.
+     * Must be called only by the producer, the elements become visible
+     * to the consumer after calling commit_write().
+     *
+     * @param count maximum number of slots requested
+     * @return regions of free slots
+     */
+    CircularBufferRegions<T> prepare_write(size_type count)
+    {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        _cachedHead = _head.load(std::memory_order_acquire);
+        const size_type available = BufferSize - Indexing::distance(_cachedHead, tail);
+        if (count > available) count = available;
+        return CircularBufferRegions<T>::wrap(_buffer.data(), BufferSize, Indexing::position(tail), count);
+    }
+
+    /**
+     * Publishes count elements written in the regions returned by prepare_write(),
+     * must be called only by the producer
+     *
+     * @param count number of elements written, at most the size of the prepared regions
+     */
+    void commit_write(size_type count)
+    {
+        const size_type tail = _tail.load(std::memory_order_relaxed);
+        _tail.store(Indexing::advance(tail, count), std::memory_order_release);
+    }
+
+    /**
+     * Returns up to count elements from the front of the buffer, as at most
+     * two contiguous regions that can be read directly.
+     * Must be called only by the consumer, the elements are released
+     * to the producer after calling commit_read().
+     *
+     * @param count maximum number of elements requested
+     * @return regions of readable elements
+     */
+    CircularBufferRegions<const T> prepare_read(size_type count)
+    {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        _cachedTail = _tail.load(std::memory_order_acquire);
+        const size_type available = Indexing::distance(head, _cachedTail);
+        if (count > available) count = available;
+        return CircularBufferRegions<const T>::wrap(_buffer.data(), BufferSize, Indexing::position(head), count);
+    }
+
+    /**
+     * Releases count elements read from the regions returned by prepare_read(),
+     * must be called only by the consumer
+     *
+     * @param count number of elements read, at most the size of the prepared regions
+     */
+    void commit_read(size_type count)
+    {
+        const size_type head = _head.load(std::memory_order_relaxed);
+        _head.store(Indexing::advance(head, count), std::memory_order_release);
+    }
+
+    /**
+     * Pushes a block of elements in the buffer, with at most two copies.
+     * Must be called only by the producer, the elements
+     * that do not fit in the buffer are discarded.
+     *
+     * @param items elements to push
+     * @param count number of elements
+     * @return number of elements added to the buffer
+     */
+    size_type write(const T *items, size_type count)
+    {
+        CircularBufferRegions<T> regions = prepare_write(count);
+        std::copy(items, items + regions.first.size, regions.first.data);
+        std::copy(items + regions.first.size, items + regions.size(), regions.second.data);
+        commit_write(regions.size());
+        return regions.size();
+    }
+
+    /**
+     * Pops a block of elements from the buffer, with at most two copies.
+     * Must be called only by the consumer.
+     *
+     * @param items destination of the elements
+     * @param count maximum number of elements
+     * @return number of elements read
+     */
+    size_type read(T *items, size_type count)
+    {
+        CircularBufferRegions<const T> regions = prepare_read(count);
+        std::copy(regions.first.data, regions.first.data + regions.first.size, items);
+        std::copy(regions.second.data, regions.second.data + regions.second.size, items + regions.first.size);
+        commit_read(regions.size());
+        return regions.size();
+    }
+
+    /**
+     * The copy constructor is disabled.
+     */
+    CircularBuffer(const CircularBuffer &) = delete;
+
+    /**
+     * The move operator is disabled.
+     */
+    CircularBuffer &operator=(const CircularBuffer &) = delete;
+
+private:
+    /**
+     * Underlying buffer to be used as circular
+     */
+    std::array<T, BufferSize> _buffer;
+
+    /**
+     * Head index, written by the consumer
+     */
+    alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE) std::atomic<size_type> _head;
+
+    /**
+     * Copy of the tail index owned by the consumer
+     */
+    size_type _cachedTail;
+
+    /**
+     * Tail index, written by the producer
+     */
+    alignas(CIRCULAR_BUFFER_CACHE_LINE_SIZE) std::atomic<size_type> _tail;
+
     /**
-     * Number of elements actually contained by the buffer
+     * Copy of the head index owned by the producer
      */
-    size_t _size;
+    size_type _cachedHead;
 
 };
 
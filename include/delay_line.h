@@ -0,0 +1,251 @@
+
+#ifndef MIOSIX_AUDIO_DELAY_LINE_H
+#define MIOSIX_AUDIO_DELAY_LINE_H
+
+#include "audio_config.h"
+#include "audio_buffer.h"
+#include "audio_math.h"
+#include "circular_buffer.h"
+
+/**
+ * Collection of structs to be passed as a template argument to DelayLine
+ * to choose the interpolation used for fractional delays.
+ *
+ * Each struct reads a delayed sample from a line exposing a sample(age) method,
+ * where age is the integer delay of the sample. The delay passed to read() is
+ * already bounded between minimumDelay and the maximum delay of the line.
+ */
+namespace DelayLineInterpolation {
+    /**
+     * Linear interpolation between the two nearest samples.
+     */
+    struct Linear {
+        static constexpr float minimumDelay = 0.0f;
+
+        template<typename Line>
+        inline typename Line::ValueType read(const Line &line, size_t age, float delay) {
+            const size_t integerDelay = static_cast<size_t>(delay);
+            const float fraction = delay - static_cast<float>(integerDelay);
+            age += integerDelay;
+            return AudioMath::linearInterpolation(line.sample(age), line.sample(age + 1), fraction);
+        }
+    };
+
+    /**
+     * Third order Lagrange interpolation over the four nearest samples,
+     * it needs at least one sample of delay.
+     */
+    struct Lagrange3 {
+        static constexpr float minimumDelay = 1.0f;
+
+        template<typename Line>
+        inline typename Line::ValueType read(const Line &line, size_t age, float delay) {
+            const size_t integerDelay = static_cast<size_t>(delay);
+            const float fraction = delay - static_cast<float>(integerDelay);
+            age += integerDelay;
+            return AudioMath::lagrangeInterpolation(line.sample(age - 1), line.sample(age),
+                                                    line.sample(age + 1), line.sample(age + 2), fraction);
+        }
+    };
+
+    /**
+     * First order allpass interpolation, it has a flat magnitude response
+     * but it keeps the last output as state, so each DelayLine using it
+     * must be read by a single tap, once per sample.
+     * It is best suited for delays modulated slowly, like in chorus and
+     * comb filters.
+     */
+    struct Allpass {
+        static constexpr float minimumDelay = 0.0f;
+
+        template<typename Line>
+        inline typename Line::ValueType read(const Line &line, size_t age, float delay) {
+            size_t integerDelay = static_cast<size_t>(delay);
+            float fraction = delay - static_cast<float>(integerDelay);
+            if (fraction < 0.618f && integerDelay > 0) {
+                // keeping the coefficient away from 1, where the filter
+                // has a long transient response
+                integerDelay--;
+                fraction += 1.0f;
+            }
+            const float coefficient = (1.0f - fraction) / (1.0f + fraction);
+            age += integerDelay;
+            lastOutput = coefficient * (line.sample(age) - lastOutput) + line.sample(age + 1);
+            return lastOutput;
+        }
+
+        float lastOutput = 0.0f;
+    };
+}
+
+/**
+ * Delay line with fractional delay reads, to be used to implement
+ * chorus, flanger, comb filters and similar effects.
+ *
+ * The samples are stored in a CircularBuffer with a power of two length,
+ * that is always kept full. Blocks are written with at most two copies,
+ * then each output sample is read at its own fractional delay.
+ *
+ * @tparam T type of the samples
+ * @tparam MAX_DELAY maximum delay in samples
+ * @tparam Interpolation interpolation used for fractional delays @see DelayLineInterpolation
+ * @tparam MAX_BLOCK_LEN maximum length of the blocks passed to process
+ */
+template<typename T, size_t MAX_DELAY, typename Interpolation = DelayLineInterpolation::Linear,
+        size_t MAX_BLOCK_LEN = AUDIO_PROCESSOR_BLOCK_SIZE>
+class DelayLine {
+public:
+    typedef T ValueType;
+
+    /**
+     * Length of the underlying CircularBuffer, it contains the samples of the
+     * current block plus enough history for the longest interpolated read.
+     */
+    static constexpr size_t ringSize = AudioMath::nextPowerOfTwo(MAX_DELAY + MAX_BLOCK_LEN + 2);
+
+    /**
+     * Constructor, the line starts filled with zeroes.
+     */
+    DelayLine() {
+        clear();
+    };
+
+    /**
+     * Fills the line with zeroes.
+     */
+    void clear() {
+        ring.clear();
+        auto regions = ring.prepare_write(ringSize);
+        std::fill(regions.first.data, regions.first.data + regions.first.size, static_cast<T>(0));
+        std::fill(regions.second.data, regions.second.data + regions.second.size, static_cast<T>(0));
+        ring.commit_write(regions.size());
+    }
+
+    /**
+     * Returns a sample written in the past.
+     *
+     * @param age integer delay, 0 is the last written sample
+     * @return delayed sample
+     */
+    inline T sample(size_t age) const {
+        return ring[ringSize - 1 - age];
+    };
+
+    /**
+     * Writes a block of samples in the line.
+     *
+     * @param input samples to write
+     * @param n number of samples, at most MAX_BLOCK_LEN
+     */
+    inline void write(const T *input, size_t n) {
+        ring.write(input, n);
+    };
+
+    /**
+     * Reads the line at a fractional delay relative to the last written sample.
+     * The delay is bounded between the minimum delay of the interpolation
+     * and MAX_DELAY.
+     *
+     * @param delay delay in samples
+     * @return interpolated delayed sample
+     */
+    inline T read(float delay) {
+        return read(0, delay);
+    };
+
+    /**
+     * Processes a block of samples: each output sample is the input delayed
+     * by the corresponding value of the delays array.
+     * The input and the output can be the same array.
+     *
+     * @param input input samples
+     * @param output output samples
+     * @param delays delay in samples for each output sample
+     * @param n number of samples
+     */
+    void process(const T *input, T *output, const float *delays, size_t n) {
+        while (n > 0) {
+            const size_t blockLength = (n < MAX_BLOCK_LEN) ? n : MAX_BLOCK_LEN;
+            write(input, blockLength);
+            for (size_t i = 0; i < blockLength; i++) {
+                // the sample i of the block has been written blockLength - 1 - i samples ago
+                output[i] = read(blockLength - 1 - i, delays[i]);
+            }
+            input += blockLength;
+            output += blockLength;
+            delays += blockLength;
+            n -= blockLength;
+        }
+    }
+
+    /**
+     * Processes a block of samples with a constant delay.
+     * The input and the output can be the same array.
+     *
+     * @param input input samples
+     * @param output output samples
+     * @param delay delay in samples
+     * @param n number of samples
+     */
+    void process(const T *input, T *output, float delay, size_t n) {
+        while (n > 0) {
+            const size_t blockLength = (n < MAX_BLOCK_LEN) ? n : MAX_BLOCK_LEN;
+            write(input, blockLength);
+            for (size_t i = 0; i < blockLength; i++) {
+                output[i] = read(blockLength - 1 - i, delay);
+            }
+            input += blockLength;
+            output += blockLength;
+            n -= blockLength;
+        }
+    }
+
+    /**
+     * Processes in place a channel of an AudioBuffer.
+     *
+     * @param buffer AudioBuffer to process
+     * @param channelNumber channel to process
+     * @param delays delay in samples for each sample of the buffer
+     */
+    template<size_t CHANNEL_NUM, size_t BUFFER_LEN>
+    void process(AudioBuffer<T, CHANNEL_NUM, BUFFER_LEN> &buffer, size_t channelNumber, const float *delays) {
+        static_assert(BUFFER_LEN <= MAX_BLOCK_LEN, "The AudioBuffer is longer than the MAX_BLOCK_LEN of the DelayLine");
+        T *channel = buffer.getWritePointer(channelNumber);
+        process(channel, channel, delays, BUFFER_LEN);
+    }
+
+    /**
+     * Getter for the interpolation, to inspect or reset its state.
+     *
+     * @return interpolation
+     */
+    inline Interpolation &getInterpolation() { return interpolation; };
+
+private:
+    /**
+     * Reads a sample relative to an already written sample.
+     *
+     * @param age integer delay of the reference sample
+     * @param delay fractional delay from the reference sample
+     * @return interpolated delayed sample
+     */
+    inline T read(size_t age, float delay) {
+        delay = AudioMath::clip(delay, Interpolation::minimumDelay, static_cast<float>(MAX_DELAY));
+        return interpolation.read(*this, age, delay);
+    }
+
+    /**
+     * Samples of the line, the newest is at the back.
+     */
+    CircularBuffer<T, ringSize, CircularBufferType::Overwrite, CircularBufferIndexing::PowerOfTwo<ringSize>> ring;
+
+    /**
+     * Interpolation and its state.
+     */
+    Interpolation interpolation;
+};
+
+template<typename T, size_t MAX_DELAY, typename Interpolation, size_t MAX_BLOCK_LEN>
+constexpr size_t DelayLine<T, MAX_DELAY, Interpolation, MAX_BLOCK_LEN>::ringSize;
+
+#endif //MIOSIX_AUDIO_DELAY_LINE_H
@@ -0,0 +1,214 @@
+
+#ifndef MIOSIX_AUDIO_DMA_DOUBLE_BUFFER_H
+#define MIOSIX_AUDIO_DMA_DOUBLE_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Output buffer for a DMA peripheral in circular mode, split in two halves
+ * (ping-pong): the DMA plays one half while the processing renders the other.
+ *
+ * The DMA raises a half transfer interrupt when it has played the first half,
+ * and a transfer complete interrupt when it has played the second one, then
+ * it restarts from the beginning. The interrupts are forwarded to
+ * halfTransferComplete() and transferComplete(), the processing writes the
+ * samples between acquire() and release().
+ *
+ * The state of each half is exchanged atomically between the interrupt and
+ * the processing, so that the processing never acquires the half being played.
+ * If the processing is late the DMA starts a half that is not READY, counted
+ * as an xrun: a FREE half replays its old samples, while a half still being
+ * written is torn, since the DMA cannot wait. The block of a torn half is
+ * dropped, its half is freed once played, so that it is never played after
+ * the blocks rendered later.
+ *
+ * @tparam T type of the samples
+ * @tparam HALF_SIZE number of samples of each half
+ */
+template<typename T, size_t HALF_SIZE>
+class DmaDoubleBuffer {
+public:
+
+    /**
+     * State of a half of the buffer.
+     */
+    enum HalfState : uint8_t {
+        /**
+         * Played by the DMA, it can be written.
+         */
+        FREE,
+
+        /**
+         * Acquired by the processing.
+         */
+        WRITING,
+
+        /**
+         * Released by the processing, waiting for the DMA.
+         */
+        READY,
+
+        /**
+         * Being played by the DMA.
+         */
+        PLAYING,
+
+        /**
+         * Acquired by the processing and being played by the DMA,
+         * the block is dropped.
+         */
+        TORN,
+
+        /**
+         * Acquired by the processing after its period has been played,
+         * the block is dropped.
+         */
+        STALE
+    };
+
+    /**
+     * Constructor.
+     */
+    DmaDoubleBuffer() { reset(); };
+
+    /**
+     * Clears the samples and restores the initial state, where the DMA
+     * plays the first half and the second one can be written.
+     * To be called before the DMA is started.
+     */
+    void reset() {
+        for (size_t i = 0; i < 2 * HALF_SIZE; i++) buffer[i] = T(0);
+        states[0].store(PLAYING, std::memory_order_relaxed);
+        states[1].store(FREE, std::memory_order_relaxed);
+        writingHalf = 0;
+        xruns.store(0, std::memory_order_relaxed);
+    };
+
+    /**
+     * Start of the buffer, to be used as the memory of the DMA transfer.
+     *
+     * @return pointer to 2 * HALF_SIZE samples
+     */
+    inline T *data() { return buffer; };
+
+    /**
+     * Number of samples of the whole buffer.
+     *
+     * @return size
+     */
+    static constexpr size_t size() { return 2 * HALF_SIZE; };
+
+    /**
+     * Interrupt: the DMA has played the first half and starts the second one.
+     *
+     * @return state of the second half before it started playing,
+     * READY unless an xrun occurred, WRITING or STALE if it is torn
+     */
+    inline HalfState halfTransferComplete() { return endOfHalf(0); };
+
+    /**
+     * Interrupt: the DMA has played the second half and starts the first one.
+     *
+     * @return state of the first half before it started playing,
+     * READY unless an xrun occurred, WRITING or STALE if it is torn
+     */
+    inline HalfState transferComplete() { return endOfHalf(1); };
+
+    /**
+     * Processing: acquires the half played last, in order to render a new block.
+     *
+     * @return pointer to HALF_SIZE samples, nullptr if no half is free
+     */
+    T *acquire() {
+        for (size_t half = 0; half < 2; half++) {
+            uint8_t expected = FREE;
+            if (states[half].compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+                writingHalf = half;
+                return buffer + half * HALF_SIZE;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Processing: marks the half returned by acquire() as ready to be played,
+     * unless the DMA has already started it: then the block is dropped and
+     * the half is freed, at the end of its period if it is still playing.
+     */
+    void release() {
+        std::atomic<uint8_t> &half = states[writingHalf];
+        uint8_t state = half.load(std::memory_order_relaxed);
+        uint8_t next;
+        do {
+            next = (state == WRITING) ? READY : (state == TORN) ? PLAYING : FREE;
+        } while (!half.compare_exchange_weak(state, next, std::memory_order_acq_rel));
+    };
+
+    /**
+     * Getter for the state of a half.
+     *
+     * @param half 0 or 1
+     * @return state
+     */
+    inline HalfState getState(size_t half) const {
+        return static_cast<HalfState>(states[half].load(std::memory_order_acquire));
+    };
+
+    /**
+     * Number of halves that were not ready when the DMA started playing them.
+     *
+     * @return xrun count
+     */
+    inline size_t getXruns() const { return xruns.load(std::memory_order_relaxed); };
+
+    DmaDoubleBuffer(const DmaDoubleBuffer &) = delete;
+
+    DmaDoubleBuffer &operator=(const DmaDoubleBuffer &) = delete;
+
+private:
+
+    /**
+     * Frees the half that has been played and starts playing the other one.
+     *
+     * @param half half that has been played
+     * @return previous state of the other half
+     */
+    HalfState endOfHalf(size_t half) {
+        // a TORN half still being written has missed its period, it is freed by release()
+        std::atomic<uint8_t> &played = states[half];
+        uint8_t state = played.load(std::memory_order_relaxed);
+        while ((state == PLAYING || state == TORN) &&
+               !played.compare_exchange_weak(state, (state == TORN) ? STALE : FREE, std::memory_order_acq_rel)) {}
+
+        // a FREE half is replayed with its old samples, one still being written
+        // is left to the processing, the DMA plays whatever is already in memory
+        std::atomic<uint8_t> &next = states[1 - half];
+        state = next.load(std::memory_order_acquire);
+        uint8_t playing;
+        do {
+            playing = (state == WRITING || state == STALE) ? TORN : PLAYING;
+        } while (!next.compare_exchange_weak(state, playing, std::memory_order_acq_rel));
+        if (state != READY) {
+            xruns.store(xruns.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        return static_cast<HalfState>(state);
+    }
+
+    T buffer[2 * HALF_SIZE];
+
+    std::atomic<uint8_t> states[2];
+
+    /**
+     * Half acquired by the processing.
+     */
+    size_t writingHalf;
+
+    /**
+     * Written by the interrupt only.
+     */
+    std::atomic<size_t> xruns;
+};
+
+#endif //MIOSIX_AUDIO_DMA_DOUBLE_BUFFER_H
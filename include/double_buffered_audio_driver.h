@@ -0,0 +1,103 @@
+
+#ifndef MIOSIX_AUDIO_DOUBLE_BUFFERED_AUDIO_DRIVER_H
+#define MIOSIX_AUDIO_DOUBLE_BUFFERED_AUDIO_DRIVER_H
+
+#include <cstdint>
+#include "audio_driver.h"
+#include "dma_double_buffer.h"
+
+/**
+ * AudioDriver with a ping-pong output buffer, for DMA peripherals with
+ * half transfer and transfer complete interrupts.
+ *
+ * The DMA plays the output buffer in circular mode, while the processor
+ * renders the next block into the half that has just been played, so the
+ * output transfer never waits for the processing to finish.
+ * The implementation forwards the interrupts to onHalfTransfer() and
+ * onTransferComplete(), and its start() loop calls processPendingHalf()
+ * after each interrupt:
+ *
+ * <pre>
+ * void start() {
+ *     while (true) {
+ *         waitForDmaInterrupt();
+ *         processPendingHalf();
+ *     }
+ * }
+ * </pre>
+ *
+ * @tparam T type of the DAC samples, int16_t or int32_t (see writeToOutputBuffer)
+ */
+template<typename T = int16_t>
+class DoubleBufferedAudioDriver : public AudioDriver {
+public:
+
+    /**
+     * Each half holds AUDIO_DRIVER_BUFFER_SIZE interleaved stereo samples.
+     */
+    typedef DmaDoubleBuffer<T, 2 * AUDIO_DRIVER_BUFFER_SIZE> OutputBuffer;
+
+    /**
+     * Getter for the output buffer, to configure the DMA transfer
+     * with data() and size().
+     *
+     * @return output buffer
+     */
+    inline OutputBuffer &getOutputBuffer() { return outputBuffer; };
+
+    /**
+     * To be called by the half transfer interrupt.
+     *
+     * @return state of the half starting to play, READY unless an xrun occurred
+     */
+    inline typename OutputBuffer::HalfState onHalfTransfer() {
+        return reportState(outputBuffer.halfTransferComplete());
+    };
+
+    /**
+     * To be called by the transfer complete interrupt.
+     *
+     * @return state of the half starting to play, READY unless an xrun occurred
+     */
+    inline typename OutputBuffer::HalfState onTransferComplete() {
+        return reportState(outputBuffer.transferComplete());
+    };
+
+    /**
+     * Renders a block into the free half of the output buffer, if any.
+     *
+     * @return false if both the halves are in use
+     */
+    bool processPendingHalf() {
+        T *half = outputBuffer.acquire();
+        if (half == nullptr) return false;
+        getCallback().process();
+        writeToOutputBuffer(half);
+        outputBuffer.release();
+        return true;
+    };
+
+    /**
+     * Number of halves played before being rendered.
+     *
+     * @return xrun count
+     */
+    inline size_t getXruns() const { return outputBuffer.getXruns(); };
+
+protected:
+
+    /**
+     * Reports the xruns also to the load meter.
+     */
+    inline typename OutputBuffer::HalfState reportState(typename OutputBuffer::HalfState state) {
+        if (state != OutputBuffer::READY) reportXrun();
+        return state;
+    };
+
+    /**
+     * Ping-pong buffer played by the DMA.
+     */
+    OutputBuffer outputBuffer;
+};
+
+#endif //MIOSIX_AUDIO_DOUBLE_BUFFERED_AUDIO_DRIVER_H
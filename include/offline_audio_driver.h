@@ -0,0 +1,192 @@
+
+#ifndef MIOSIX_AUDIO_OFFLINE_AUDIO_DRIVER_H
+#define MIOSIX_AUDIO_OFFLINE_AUDIO_DRIVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include "audio_driver.h"
+
+/**
+ * AudioDriver that renders the output of the AudioProcessable
+ * to a 16 bit stereo WAV file, calling the process callback as fast
+ * as possible instead of following a DAC clock.
+ *
+ * It can be used to run an AudioProcessor on a desktop machine,
+ * for tests, continuous integration or batch rendering, and to
+ * measure its throughput with the realtime factor.
+ */
+class OfflineAudioDriver : public AudioDriver {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param filePath path of the WAV file to write, nullptr to
+     * run the processing without writing any file
+     * @param blockNumber number of blocks of AUDIO_DRIVER_BUFFER_SIZE samples to render
+     */
+    OfflineAudioDriver(const char *filePath, size_t blockNumber) : filePath(filePath),
+                                                                   blockNumber(blockNumber),
+                                                                   file(nullptr),
+                                                                   renderedBlocks(0),
+                                                                   elapsedSeconds(0.0) {};
+
+    /**
+     * Opens the output file.
+     *
+     * @return false if the file cannot be opened
+     */
+    bool init() {
+        setSampleRate(AUDIO_DRIVER_SAMPLE_RATE);
+        if (filePath == nullptr) return true;
+        file = std::fopen(filePath, "wb");
+        if (file == nullptr) return false;
+
+        // the sizes are written at the end of the rendering
+        writeHeader(0);
+        return true;
+    };
+
+    /**
+     * Renders all the blocks, then closes the file.
+     * Unlike a hardware driver, it returns at the end of the rendering.
+     *
+     * @return false if an error occurred while writing the file
+     */
+    bool start() {
+        int16_t rawBuffer[2 * AUDIO_DRIVER_BUFFER_SIZE];
+        bool success = true;
+        renderedBlocks = 0;
+
+        const auto startTime = std::chrono::steady_clock::now();
+        for (size_t block = 0; block < blockNumber && success; block++) {
+            getCallback().process();
+            renderedBlocks++;
+            if (file != nullptr) {
+                writeToOutputBuffer(rawBuffer);
+                writeSamples(rawBuffer, 2 * AUDIO_DRIVER_BUFFER_SIZE);
+                success = std::ferror(file) == 0;
+            }
+        }
+        const auto endTime = std::chrono::steady_clock::now();
+        elapsedSeconds = std::chrono::duration<double>(endTime - startTime).count();
+
+        if (file != nullptr) {
+            std::fseek(file, 0, SEEK_SET);
+            writeHeader(static_cast<uint32_t>(renderedBlocks * 2 * AUDIO_DRIVER_BUFFER_SIZE * sizeof(int16_t)));
+            success = (std::ferror(file) == 0) & success;
+            success = (std::fclose(file) == 0) & success;
+            file = nullptr;
+        }
+        return success;
+    };
+
+    /**
+     * Duration of the rendered audio.
+     *
+     * @return seconds of audio
+     */
+    inline double getRenderedSeconds() const {
+        return static_cast<double>(renderedBlocks * AUDIO_DRIVER_BUFFER_SIZE) / getSampleRate();
+    };
+
+    /**
+     * Wall clock time spent in the last start().
+     *
+     * @return seconds
+     */
+    inline double getElapsedSeconds() const { return elapsedSeconds; };
+
+    /**
+     * Seconds of audio rendered per second of wall clock time,
+     * a value greater than 1 means faster than realtime.
+     *
+     * @return realtime factor
+     */
+    inline double getRealtimeFactor() const {
+        return (elapsedSeconds > 0.0) ? getRenderedSeconds() / elapsedSeconds : 0.0;
+    };
+
+    /**
+     * Destructor, closes the file if the rendering has not been started.
+     */
+    ~OfflineAudioDriver() {
+        if (file != nullptr) std::fclose(file);
+    };
+
+private:
+
+    /**
+     * Writes an unsigned integer in little endian.
+     */
+    void writeInteger(uint32_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            std::fputc(static_cast<int>((value >> (8 * i)) & 0xFF), file);
+        }
+    };
+
+    /**
+     * Writes the 44 bytes header of a PCM WAV file.
+     *
+     * @param dataSize size in bytes of the samples
+     */
+    void writeHeader(uint32_t dataSize) {
+        const uint32_t channels = 2;
+        const uint32_t bytesPerSample = sizeof(int16_t);
+        const uint32_t rate = static_cast<uint32_t>(getSampleRate());
+
+        std::fwrite("RIFF", 1, 4, file);
+        writeInteger(36 + dataSize, 4);
+        std::fwrite("WAVEfmt ", 1, 8, file);
+        writeInteger(16, 4); // size of the fmt chunk
+        writeInteger(1, 2); // PCM
+        writeInteger(channels, 2);
+        writeInteger(rate, 4);
+        writeInteger(rate * channels * bytesPerSample, 4);
+        writeInteger(channels * bytesPerSample, 2);
+        writeInteger(8 * bytesPerSample, 2);
+        std::fwrite("data", 1, 4, file);
+        writeInteger(dataSize, 4);
+    };
+
+    /**
+     * Writes interleaved samples in little endian.
+     */
+    void writeSamples(const int16_t *samples, size_t n) {
+        uint8_t bytes[2 * 2 * AUDIO_DRIVER_BUFFER_SIZE];
+        for (size_t i = 0; i < n; i++) {
+            const uint16_t sample = static_cast<uint16_t>(samples[i]);
+            bytes[2 * i] = static_cast<uint8_t>(sample & 0xFF);
+            bytes[2 * i + 1] = static_cast<uint8_t>(sample >> 8);
+        }
+        std::fwrite(bytes, 1, 2 * n, file);
+    };
+
+    /**
+     * Path of the output file.
+     */
+    const char *filePath;
+
+    /**
+     * Number of blocks to render.
+     */
+    size_t blockNumber;
+
+    /**
+     * Output file.
+     */
+    std::FILE *file;
+
+    /**
+     * Number of blocks rendered by the last start().
+     */
+    size_t renderedBlocks;
+
+    /**
+     * Wall clock duration of the last start().
+     */
+    double elapsedSeconds;
+};
+
+#endif //MIOSIX_AUDIO_OFFLINE_AUDIO_DRIVER_H
@@ -0,0 +1,269 @@
+
+#ifndef MIOSIX_AUDIO_PARAMETER_REGISTRY_H
+#define MIOSIX_AUDIO_PARAMETER_REGISTRY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include "audio_parameter.h"
+
+/**
+ * Central index of the parameters of an application, smoothed with
+ * a linear ramp like AudioParameter.
+ *
+ * Each parameter is registered with add(), that returns its stable id
+ * (the registration order). The state of all the parameters is stored
+ * in contiguous arrays, one per field, so that the audio thread updates
+ * all the smoothers at once with a few loops over the arrays.
+ *
+ * The control thread edits its own copy of the values, and publishes
+ * them as a whole snapshot (e.g. a preset) with publish(). The snapshots
+ * are exchanged through a lock free triple buffer: the audio thread
+ * picks up the last published one in update(), once per block.
+ *
+ * Registration must happen before the audio thread starts using the registry.
+ *
+ * @tparam MAX_PARAMETERS maximum number of parameters
+ */
+template<size_t MAX_PARAMETERS>
+class ParameterRegistry {
+public:
+    typedef size_t ParameterId;
+
+    /**
+     * Id returned when the registry is full.
+     */
+    static constexpr ParameterId invalidId = MAX_PARAMETERS;
+
+    /**
+     * Values of all the parameters, indexed by id.
+     */
+    typedef std::array<float, MAX_PARAMETERS> Snapshot;
+
+    /**
+     * Constructor.
+     */
+    ParameterRegistry() : parameterNumber(0), front(0), back(1), middle(2) {
+        controlValues.fill(0.0f);
+        for (Snapshot &snapshot : snapshots) snapshot.fill(0.0f);
+        lastValues.fill(0.0f);
+        currentValues.fill(0.0f);
+        progress.fill(1.0f);
+        progressSteps.fill(1.0f);
+        names.fill(nullptr);
+    };
+
+    /**
+     * Registers a new parameter.
+     *
+     * @param name name of the parameter, the string is not copied
+     * @param value initial value
+     * @param transitionSamples number of samples of the transitions
+     * @return id of the parameter, or invalidId if the registry is full
+     */
+    ParameterId add(const char *name, float value,
+                    size_t transitionSamples = AUDIO_PARAMETER_DEFAULT_TRANSITION_SAMPLES) {
+        if (parameterNumber == MAX_PARAMETERS) return invalidId;
+        const ParameterId id = parameterNumber++;
+        names[id] = name;
+        controlValues[id] = value;
+        for (Snapshot &snapshot : snapshots) snapshot[id] = value;
+        lastValues[id] = value;
+        currentValues[id] = value;
+        progress[id] = 1.0f;
+        setTransitionSamples(id, transitionSamples);
+        return id;
+    }
+
+    /**
+     * Finds a parameter by name.
+     *
+     * @param name name of the parameter
+     * @return id of the parameter, or invalidId if it is not registered
+     */
+    ParameterId find(const char *name) const {
+        for (ParameterId id = 0; id < parameterNumber; id++) {
+            if (std::strcmp(names[id], name) == 0) return id;
+        }
+        return invalidId;
+    }
+
+    /**
+     * Number of registered parameters.
+     *
+     * @return size
+     */
+    inline size_t size() const { return parameterNumber; };
+
+    /**
+     * Sets the length of the transitions of a parameter.
+     *
+     * @param id parameter
+     * @param sampleNumber number of samples of the transitions
+     */
+    inline void setTransitionSamples(ParameterId id, size_t sampleNumber) {
+        progressSteps[id] = (sampleNumber > 0) ? 1.0f / static_cast<float>(sampleNumber) : 1.0f;
+    };
+
+    /**
+     * Control thread: changes a value of the snapshot under edit,
+     * it takes effect at the next publish().
+     *
+     * @param id parameter
+     * @param value new value
+     */
+    inline void setValue(ParameterId id, float value) { controlValues[id] = value; };
+
+    /**
+     * Control thread: replaces the snapshot under edit, e.g. to load a preset.
+     *
+     * @param snapshot values indexed by id
+     */
+    inline void setSnapshot(const Snapshot &snapshot) { controlValues = snapshot; };
+
+    /**
+     * Control thread: getter for the snapshot under edit.
+     *
+     * @return values indexed by id
+     */
+    inline const Snapshot &getSnapshot() const { return controlValues; };
+
+    /**
+     * Control thread: publishes the snapshot under edit, that is
+     * picked up atomically by the next update() of the audio thread.
+     */
+    void publish() {
+        std::copy(controlValues.begin(), controlValues.begin() + parameterNumber, snapshots[back].begin());
+        back = middle.exchange(back | freshFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /**
+     * Audio thread: picks up the last published snapshot, if any,
+     * starting a transition for each parameter that has changed.
+     * To be called at the start of each block.
+     */
+    void update() {
+        if (!(middle.load(std::memory_order_relaxed) & freshFlag)) return;
+        front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+
+        const Snapshot &targets = snapshots[front];
+        for (ParameterId id = 0; id < parameterNumber; id++) {
+            const bool changed = targets[id] != currentValues[id];
+            lastValues[id] = changed ? getInterpolatedValue(id) : lastValues[id];
+            progress[id] = changed ? 0.0f : progress[id];
+            currentValues[id] = targets[id];
+        }
+    }
+
+    /**
+     * Audio thread: advances all the transitions by a number of samples,
+     * to be called at the end of each block.
+     *
+     * @param sampleNumber number of samples
+     */
+    void advance(size_t sampleNumber) {
+        const float samples = static_cast<float>(sampleNumber);
+        for (ParameterId id = 0; id < parameterNumber; id++) {
+            const float p = progress[id] + samples * progressSteps[id];
+            progress[id] = (p < 1.0f) ? p : 1.0f;
+        }
+    }
+
+    /**
+     * Audio thread: smoothed value of a parameter at the start of the block.
+     *
+     * @param id parameter
+     * @return interpolated value
+     */
+    inline float getInterpolatedValue(ParameterId id) const {
+        return (progress[id] < 1.0f)
+               ? lastValues[id] + (currentValues[id] - lastValues[id]) * progress[id] : currentValues[id];
+    };
+
+    /**
+     * Audio thread: target value of a parameter.
+     *
+     * @param id parameter
+     * @return current value
+     */
+    inline float getValue(ParameterId id) const { return currentValues[id]; };
+
+    /**
+     * Audio thread: writes the smoothed values of a parameter
+     * for the samples of the block, without advancing the transition.
+     *
+     * @param id parameter
+     * @param dst destination array
+     * @param n number of samples
+     */
+    void fillRamp(ParameterId id, float *dst, size_t n) const {
+        if (progress[id] >= 1.0f) {
+            AudioSimd::fill(dst, currentValues[id], n);
+            return;
+        }
+        const float delta = currentValues[id] - lastValues[id];
+        for (size_t i = 0; i < n; i++) {
+            const float p = progress[id] + static_cast<float>(i) * progressSteps[id];
+            dst[i] = lastValues[id] + delta * ((p < 1.0f) ? p : 1.0f);
+        }
+    }
+
+    /**
+     * Audio thread: indicates if the transition of a parameter is complete.
+     *
+     * @param id parameter
+     * @return boolean flag
+     */
+    inline bool transitionIsComplete(ParameterId id) const { return progress[id] >= 1.0f; };
+
+    ParameterRegistry(const ParameterRegistry &) = delete;
+
+    ParameterRegistry &operator=(const ParameterRegistry &) = delete;
+
+private:
+    static constexpr uint8_t indexMask = 0x3;
+    static constexpr uint8_t freshFlag = 0x4;
+
+    size_t parameterNumber;
+
+    /**
+     * Names of the parameters.
+     */
+    std::array<const char *, MAX_PARAMETERS> names;
+
+    /**
+     * Snapshot under edit, owned by the control thread.
+     */
+    Snapshot controlValues;
+
+    /**
+     * Triple buffer of published snapshots: the control thread owns
+     * the back one, the audio thread the front one, the middle one is
+     * exchanged atomically together with a flag marking it as fresh.
+     */
+    std::array<Snapshot, 3> snapshots;
+    uint8_t front;
+    uint8_t back;
+    std::atomic<uint8_t> middle;
+
+    /**
+     * Structure of arrays with the state of the smoothers, owned by the audio thread.
+     */
+    Snapshot lastValues;
+    Snapshot currentValues;
+    Snapshot progress;
+    Snapshot progressSteps;
+};
+
+template<size_t MAX_PARAMETERS>
+constexpr typename ParameterRegistry<MAX_PARAMETERS>::ParameterId ParameterRegistry<MAX_PARAMETERS>::invalidId;
+
+template<size_t MAX_PARAMETERS>
+constexpr uint8_t ParameterRegistry<MAX_PARAMETERS>::indexMask;
+
+template<size_t MAX_PARAMETERS>
+constexpr uint8_t ParameterRegistry<MAX_PARAMETERS>::freshFlag;
+
+#endif //MIOSIX_AUDIO_PARAMETER_REGISTRY_H
@@ -0,0 +1,153 @@
+
+#ifndef MIOSIX_AUDIO_SIMULATED_DMA_AUDIO_DRIVER_H
+#define MIOSIX_AUDIO_SIMULATED_DMA_AUDIO_DRIVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "double_buffered_audio_driver.h"
+
+/**
+ * DoubleBufferedAudioDriver that simulates a circular DMA on a desktop
+ * machine, to test the ping-pong processing before running it on the target.
+ *
+ * A thread plays the output buffer in place of the DMA: it passes each half
+ * to an observer, waits for AUDIO_DRIVER_BUFFER_SIZE / sampleRate seconds
+ * and raises the corresponding interrupt. The thread calling start() waits
+ * for the interrupts and renders the free halves, like the audio thread
+ * of a hardware driver.
+ *
+ * @tparam T type of the DAC samples, int16_t or int32_t
+ */
+template<typename T = int16_t>
+class SimulatedDmaAudioDriver : public DoubleBufferedAudioDriver<T> {
+public:
+    typedef typename DoubleBufferedAudioDriver<T>::OutputBuffer OutputBuffer;
+
+    /**
+     * Called by the simulated DMA with each half it plays, the samples
+     * are nullptr when the half does not hold a new block: when it is torn,
+     * being still written by the processing, or replayed after an xrun.
+     */
+    typedef std::function<void(const T *samples, size_t n)> Observer;
+
+    /**
+     * Constructor.
+     *
+     * @param halfNumber number of halves to play
+     */
+    explicit SimulatedDmaAudioDriver(size_t halfNumber) : halfNumber(halfNumber),
+                                                          tornHalves(0),
+                                                          interrupts(0),
+                                                          running(false) {};
+
+    /**
+     * Initializes the driver.
+     */
+    void init() {
+        this->setSampleRate(AUDIO_DRIVER_SAMPLE_RATE);
+        this->outputBuffer.reset();
+        tornHalves = 0;
+    };
+
+    /**
+     * Sets the observer of the played halves, it is called by the DMA thread.
+     *
+     * @param newObserver observer
+     */
+    inline void setOutputObserver(const Observer &newObserver) { observer = newObserver; };
+
+    /**
+     * Blocking call that starts the DMA thread and renders
+     * the halves until halfNumber halves are played.
+     */
+    void start() {
+        std::unique_lock<std::mutex> lock(mutex);
+        running = true;
+        interrupts = 0;
+        std::thread dmaThread([this] { runDma(); });
+
+        size_t handledInterrupts = 0;
+        while (running) {
+            lock.unlock();
+            while (this->processPendingHalf()) {}
+            lock.lock();
+            interrupt.wait(lock, [&] { return interrupts != handledInterrupts || !running; });
+            handledInterrupts = interrupts;
+        }
+        lock.unlock();
+        dmaThread.join();
+    };
+
+    /**
+     * Number of halves played while being written, to be read after start() returns.
+     *
+     * @return torn halves
+     */
+    inline size_t getTornHalves() const { return tornHalves; };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Body of the DMA thread.
+     */
+    void runDma() {
+        const double seconds = AUDIO_DRIVER_BUFFER_SIZE / static_cast<double>(this->getSampleRate());
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        auto wakeUp = Clock::now();
+        OutputBuffer &output = this->getOutputBuffer();
+
+        // the first half is PLAYING after the reset
+        typename OutputBuffer::HalfState state = OutputBuffer::READY;
+        for (size_t k = 0; k < halfNumber; k++) {
+            const size_t half = k % 2;
+            if (state == OutputBuffer::WRITING || state == OutputBuffer::STALE) tornHalves++;
+            if (state != OutputBuffer::READY) {
+                if (observer) observer(nullptr, output.size() / 2);
+            } else if (observer) {
+                observer(output.data() + half * output.size() / 2, output.size() / 2);
+            }
+
+            wakeUp += period;
+            std::this_thread::sleep_until(wakeUp);
+            state = (half == 0) ? this->onHalfTransfer() : this->onTransferComplete();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                interrupts++;
+            }
+            interrupt.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+        }
+        interrupt.notify_one();
+    };
+
+    /**
+     * Number of halves to play.
+     */
+    size_t halfNumber;
+
+    /**
+     * Written by the DMA thread.
+     */
+    size_t tornHalves;
+
+    Observer observer;
+
+    /**
+     * Simulated interrupt line: the counter of the raised
+     * interrupts and the running flag are guarded by the mutex.
+     */
+    std::mutex mutex;
+    std::condition_variable interrupt;
+    size_t interrupts;
+    bool running;
+};
+
+#endif //MIOSIX_AUDIO_SIMULATED_DMA_AUDIO_DRIVER_H
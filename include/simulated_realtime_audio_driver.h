@@ -0,0 +1,169 @@
+
+#ifndef MIOSIX_AUDIO_SIMULATED_REALTIME_AUDIO_DRIVER_H
+#define MIOSIX_AUDIO_SIMULATED_REALTIME_AUDIO_DRIVER_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "audio_driver.h"
+
+/**
+ * Timing statistics collected by the SimulatedRealtimeAudioDriver.
+ * All the times are in seconds.
+ */
+struct AudioDriverStats {
+    /**
+     * Number of process callbacks.
+     */
+    size_t callbacks = 0;
+
+    /**
+     * Number of callbacks that ended after their deadline.
+     */
+    size_t xruns = 0;
+
+    /**
+     * Time available for each callback, AUDIO_DRIVER_BUFFER_SIZE / sampleRate.
+     */
+    double deadline = 0.0;
+
+    /**
+     * Longest execution time of a callback.
+     */
+    double maxExecutionTime = 0.0;
+
+    /**
+     * Sum of the execution times of the callbacks.
+     */
+    double totalExecutionTime = 0.0;
+
+    /**
+     * Longest delay between the scheduled wake up of the
+     * audio thread and the start of the callback.
+     */
+    double maxWakeUpLatency = 0.0;
+
+    /**
+     * Average execution time of a callback.
+     *
+     * @return seconds
+     */
+    inline double getAverageExecutionTime() const {
+        return (callbacks > 0) ? totalExecutionTime / callbacks : 0.0;
+    };
+
+    /**
+     * Average fraction of the deadline used by the callbacks.
+     *
+     * @return load between 0 and 1 (greater than 1 when overloaded)
+     */
+    inline double getLoad() const {
+        return (deadline > 0.0) ? getAverageExecutionTime() / deadline : 0.0;
+    };
+};
+
+/**
+ * AudioDriver that simulates the timing of a hardware driver on a
+ * desktop machine, to validate the callback latency before running
+ * the application on the target.
+ *
+ * The process callback is run on a dedicated thread, woken up every
+ * AUDIO_DRIVER_BUFFER_SIZE / sampleRate seconds like a DMA interrupt.
+ * Each callback is measured against its deadline, that is the next
+ * wake up, and the callbacks ending late are counted as xruns.
+ * After an xrun the schedule restarts from the end of the late callback,
+ * as a hardware driver would do after an underrun.
+ */
+class SimulatedRealtimeAudioDriver : public AudioDriver {
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param blockNumber number of callbacks to run, 0 to run until stop() is called
+     */
+    explicit SimulatedRealtimeAudioDriver(size_t blockNumber = 0) : blockNumber(blockNumber), running(false) {};
+
+    /**
+     * Initializes the driver.
+     */
+    void init() {
+        setSampleRate(AUDIO_DRIVER_SAMPLE_RATE);
+        stats = AudioDriverStats();
+        stats.deadline = AUDIO_DRIVER_BUFFER_SIZE / static_cast<double>(getSampleRate());
+    };
+
+    /**
+     * Blocking call that starts the audio thread, and waits until
+     * blockNumber callbacks are run or stop() is called.
+     */
+    void start() {
+        running.store(true, std::memory_order_relaxed);
+        std::thread audioThread([this] { run(); });
+        audioThread.join();
+    };
+
+    /**
+     * Stops the audio thread after the current callback,
+     * it can be called by any thread, including the callback itself.
+     */
+    inline void stop() { running.store(false, std::memory_order_relaxed); };
+
+    /**
+     * Getter for the timing statistics, to be read after start() returns.
+     *
+     * @return statistics of the last run
+     */
+    inline const AudioDriverStats &getStats() const { return stats; };
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Body of the audio thread.
+     */
+    void run() {
+        const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(stats.deadline));
+        auto wakeUp = Clock::now();
+
+        while (running.load(std::memory_order_relaxed) && (blockNumber == 0 || stats.callbacks < blockNumber)) {
+            std::this_thread::sleep_until(wakeUp);
+            const auto begin = Clock::now();
+            getCallback().process();
+            const auto end = Clock::now();
+
+            const double executionTime = std::chrono::duration<double>(end - begin).count();
+            const double wakeUpLatency = std::chrono::duration<double>(begin - wakeUp).count();
+            stats.callbacks++;
+            stats.totalExecutionTime += executionTime;
+            stats.maxExecutionTime = (executionTime > stats.maxExecutionTime) ? executionTime : stats.maxExecutionTime;
+            stats.maxWakeUpLatency = (wakeUpLatency > stats.maxWakeUpLatency) ? wakeUpLatency : stats.maxWakeUpLatency;
+
+            // the deadline of a callback is the next wake up
+            wakeUp += period;
+            if (end > wakeUp) {
+                stats.xruns++;
+                reportXrun();
+                wakeUp = end;
+            }
+        }
+        running.store(false, std::memory_order_relaxed);
+    };
+
+    /**
+     * Number of callbacks to run, 0 for no limit.
+     */
+    size_t blockNumber;
+
+    /**
+     * Cleared to stop the audio thread.
+     */
+    std::atomic<bool> running;
+
+    /**
+     * Statistics written by the audio thread.
+     */
+    AudioDriverStats stats;
+};
+
+#endif //MIOSIX_AUDIO_SIMULATED_REALTIME_AUDIO_DRIVER_H
@@ -0,0 +1,220 @@
+
+#ifndef MIOSIX_AUDIO_STATIC_CHAIN_H
+#define MIOSIX_AUDIO_STATIC_CHAIN_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "audio_config.h"
+#include "audio_buffer.h"
+#include "audio_module.h"
+
+/**
+ * Helpers to compose modules at compile time.
+ */
+namespace StaticModule {
+
+    /**
+     * Channel number of an AudioModule.
+     */
+    template<size_t CHANNEL_NUM>
+    std::integral_constant<size_t, CHANNEL_NUM> channels(const AudioModule<CHANNEL_NUM> *);
+
+    /**
+     * Channel number of a composition, e.g. a StaticChain.
+     */
+    template<typename Module>
+    std::integral_constant<size_t, Module::channelNumber> channels(const Module *);
+
+    /**
+     * Number of channels processed by a module.
+     *
+     * @tparam Module AudioModule or static composition
+     */
+    template<typename Module>
+    struct ChannelNumber : decltype(channels(static_cast<const Module *>(nullptr))) {
+    };
+
+    /**
+     * Checks that all the modules have the same number of channels.
+     */
+    template<size_t CHANNEL_NUM, typename... Modules>
+    struct SameChannels : std::true_type {
+    };
+
+    template<size_t CHANNEL_NUM, typename Module, typename... Modules>
+    struct SameChannels<CHANNEL_NUM, Module, Modules...>
+            : std::integral_constant<bool, ChannelNumber<Module>::value == CHANNEL_NUM &&
+                                           SameChannels<CHANNEL_NUM, Modules...>::value> {
+    };
+
+    /**
+     * Modules whose process method cannot be overridden by a derived type:
+     * final classes, and compositions without virtual methods.
+     */
+    template<typename Module>
+    struct IsSealed : std::integral_constant<bool, std::is_final<Module>::value ||
+                                                   !std::is_polymorphic<Module>::value> {
+    };
+
+    template<typename Module, typename Buffer>
+    inline void process(Module &module, Buffer &buffer, std::true_type) {
+        module.Module::process(buffer);
+    }
+
+    template<typename Module, typename Buffer>
+    inline void process(Module &module, Buffer &buffer, std::false_type) {
+        module.process(buffer);
+    }
+
+    /**
+     * Calls the process method of a module: without virtual dispatch, so that
+     * it can be inlined, when the type cannot be overridden, otherwise through
+     * the virtual call, since the object can be of a derived type.
+     */
+    template<typename Module, typename Buffer>
+    inline void process(Module &module, Buffer &buffer) {
+        process(module, buffer, IsSealed<Module>());
+    }
+}
+
+/**
+ * Chain of modules known at compile time, processing a buffer in place
+ * one module after the other.
+ *
+ * Unlike a loop over AudioModule pointers, the modules declared final are
+ * called through their concrete type, with no virtual dispatch, so the
+ * compiler can inline the whole chain. The other AudioModules may be bound
+ * to objects of a derived type, so they are called through the virtual
+ * method. The modules are referenced, not owned, and can be AudioModules
+ * or other static compositions.
+ *
+ * @tparam Modules types of the modules, in processing order
+ */
+template<typename... Modules>
+class StaticChain {
+public:
+    static_assert(sizeof...(Modules) > 0, "a StaticChain needs at least a module");
+
+    static constexpr size_t channelNumber =
+            StaticModule::ChannelNumber<typename std::tuple_element<0, std::tuple<Modules...>>::type>::value;
+
+    static_assert(StaticModule::SameChannels<channelNumber, Modules...>::value,
+                  "the modules of a StaticChain must have the same number of channels");
+
+    typedef AudioBuffer<float, channelNumber, AUDIO_PROCESSOR_BLOCK_SIZE> Buffer;
+
+    /**
+     * Constructor.
+     *
+     * @param modules modules of the chain, in processing order
+     */
+    explicit StaticChain(Modules &... modules) : modules(modules...) {};
+
+    /**
+     * Processes a buffer through all the modules.
+     *
+     * @param buffer buffer processed in place
+     */
+    inline void process(Buffer &buffer) { processAll(buffer, std::index_sequence_for<Modules...>()); };
+
+    /**
+     * Getter for a module of the chain.
+     *
+     * @tparam I position of the module
+     * @return module
+     */
+    template<size_t I>
+    inline typename std::tuple_element<I, std::tuple<Modules...>>::type &get() { return std::get<I>(modules); };
+
+private:
+    template<size_t... I>
+    inline void processAll(Buffer &buffer, std::index_sequence<I...>) {
+        // the braced list is evaluated from left to right
+        int order[] = {(StaticModule::process(std::get<I>(modules), buffer), 0)...};
+        (void) order;
+    };
+
+    std::tuple<Modules &...> modules;
+};
+
+template<typename... Modules>
+constexpr size_t StaticChain<Modules...>::channelNumber;
+
+/**
+ * Modules known at compile time processing the same input in parallel,
+ * the output is the sum of their outputs.
+ *
+ * As for StaticChain, the final modules are called without virtual dispatch.
+ * Two internal buffers hold the input and the output of the modules after the first.
+ *
+ * @tparam Modules types of the modules
+ */
+template<typename... Modules>
+class StaticMix {
+public:
+    static_assert(sizeof...(Modules) > 0, "a StaticMix needs at least a module");
+
+    static constexpr size_t channelNumber =
+            StaticModule::ChannelNumber<typename std::tuple_element<0, std::tuple<Modules...>>::type>::value;
+
+    static_assert(StaticModule::SameChannels<channelNumber, Modules...>::value,
+                  "the modules of a StaticMix must have the same number of channels");
+
+    typedef AudioBuffer<float, channelNumber, AUDIO_PROCESSOR_BLOCK_SIZE> Buffer;
+
+    /**
+     * Constructor.
+     *
+     * @param modules modules to mix
+     */
+    explicit StaticMix(Modules &... modules) : modules(modules...) {};
+
+    /**
+     * Processes a buffer with all the modules, summing their outputs.
+     *
+     * @param buffer input, replaced by the mix
+     */
+    inline void process(Buffer &buffer) {
+        if (sizeof...(Modules) > 1) input.copyFrom(buffer);
+        processAll(buffer, std::index_sequence_for<Modules...>());
+    };
+
+    /**
+     * Getter for a module of the mix.
+     *
+     * @tparam I position of the module
+     * @return module
+     */
+    template<size_t I>
+    inline typename std::tuple_element<I, std::tuple<Modules...>>::type &get() { return std::get<I>(modules); };
+
+private:
+    template<size_t... I>
+    inline void processAll(Buffer &buffer, std::index_sequence<I...>) {
+        int order[] = {(processModule<I>(buffer), 0)...};
+        (void) order;
+    };
+
+    template<size_t I>
+    inline void processModule(Buffer &buffer) {
+        // the first module writes the output in place
+        if (I == 0) {
+            StaticModule::process(std::get<I>(modules), buffer);
+        } else {
+            scratch.copyFrom(input);
+            StaticModule::process(std::get<I>(modules), scratch);
+            buffer.add(scratch);
+        }
+    };
+
+    std::tuple<Modules &...> modules;
+    Buffer input;
+    Buffer scratch;
+};
+
+template<typename... Modules>
+constexpr size_t StaticMix<Modules...>::channelNumber;
+
+#endif //MIOSIX_AUDIO_STATIC_CHAIN_H
@@ -0,0 +1,76 @@
+#include "catch.hpp"
+#include "../include/audio_block_adapter.h"
+
+/**
+ * Renders a ramp counting the samples, the second channel is negated.
+ */
+template<size_t BLOCK_LEN>
+class RampProcessable : public AudioProcessable {
+public:
+    explicit RampProcessable(AudioBuffer<float, 2, BLOCK_LEN> &buffer) : buffer(buffer), calls(0), sampleCount(0) {};
+
+    void process() override {
+        calls++;
+        for (size_t i = 0; i < BLOCK_LEN; i++) {
+            buffer.getWritePointer(0)[i] = static_cast<float>(sampleCount);
+            buffer.getWritePointer(1)[i] = -static_cast<float>(sampleCount++);
+        }
+    }
+
+    AudioBuffer<float, 2, BLOCK_LEN> &buffer;
+    size_t calls;
+    size_t sampleCount;
+};
+
+template<size_t BLOCK_LEN, size_t BUFFER_LEN>
+void checkAdapter(size_t bufferNumber) {
+    AudioBuffer<float, 2, BUFFER_LEN> output;
+    AudioBlockAdapter<2, BLOCK_LEN, BUFFER_LEN> adapter(output);
+    RampProcessable<BLOCK_LEN> processable(adapter.getBlockBuffer());
+    adapter.setBlockProcessable(processable);
+
+    for (size_t b = 0; b < bufferNumber; b++) {
+        adapter.process();
+        for (size_t i = 0; i < BUFFER_LEN; i++) {
+            REQUIRE(output.getReadPointer(0)[i] == static_cast<float>(b * BUFFER_LEN + i));
+            REQUIRE(output.getReadPointer(1)[i] == -static_cast<float>(b * BUFFER_LEN + i));
+        }
+        // blocks are rendered only when needed
+        REQUIRE(processable.calls == ((b + 1) * BUFFER_LEN + BLOCK_LEN - 1) / BLOCK_LEN);
+    }
+}
+
+TEST_CASE("AudioBlockAdapter", "[audio]") {
+    SECTION("smaller blocks") {
+        checkAdapter<4, 16>(4);
+    }
+
+    SECTION("larger blocks") {
+        checkAdapter<32, 16>(6);
+    }
+
+    SECTION("sizes not dividing evenly") {
+        checkAdapter<6, 16>(5);
+        checkAdapter<24, 16>(5);
+    }
+
+    SECTION("same size") {
+        AudioBuffer<float, 2, 16> output;
+        AudioBlockAdapter<2, 16, 16> adapter(output);
+        // the processable writes directly into the output buffer
+        REQUIRE(&adapter.getBlockBuffer() == &output);
+        checkAdapter<16, 16>(3);
+    }
+
+    SECTION("reset") {
+        AudioBuffer<float, 2, 16> output;
+        AudioBlockAdapter<2, 24, 16> adapter(output);
+        RampProcessable<24> processable(adapter.getBlockBuffer());
+        adapter.setBlockProcessable(processable);
+        adapter.process();
+        adapter.reset();
+        adapter.process();
+        REQUIRE(processable.calls == 2);
+        REQUIRE(output.getReadPointer(0)[0] == 24.0f);
+    }
+}
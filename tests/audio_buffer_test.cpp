@@ -53,4 +53,116 @@ TEST_CASE("AudioBuffer", "[audio]") {
             REQUIRE(buffer1.getBufferContainer() == buffer2.getBufferContainer());
         }
     }
-}
\ No newline at end of file
+
+    SECTION("float vectorized kernels") {
+        // the length is not a multiple of the SIMD width, to test the scalar tail
+        AudioBuffer<float, 3, 22> buffer1;
+        AudioBuffer<float, 3, 22> buffer2;
+        AudioBuffer<float, 3, 22> buffer3;
+        for (size_t channel = 0; channel < 3; channel++) {
+            float *raw1 = buffer1.getWritePointer(channel);
+            float *raw2 = buffer2.getWritePointer(channel);
+            for (size_t i = 0; i < 22; i++) {
+                raw1[i] = static_cast<float>(i) + channel;
+                raw2[i] = 0.5f * static_cast<float>(i) - 3.0f;
+            }
+        }
+
+        SECTION("gain") {
+            buffer3.copyFrom(buffer1);
+            buffer3.applyGain(0.25f);
+            for (size_t channel = 0; channel < 3; channel++) {
+                for (size_t i = 0; i < 22; i++) {
+                    REQUIRE(buffer3.getReadPointer(channel)[i] ==
+                            Approx(buffer1.getReadPointer(channel)[i] * 0.25f));
+                }
+            }
+        }
+
+        SECTION("summing and multiplying") {
+            buffer3.copyFrom(buffer1);
+            buffer3.add(buffer2);
+            buffer3.multiply(buffer2);
+            for (size_t channel = 0; channel < 3; channel++) {
+                for (size_t i = 0; i < 22; i++) {
+                    float a = buffer1.getReadPointer(channel)[i];
+                    float b = buffer2.getReadPointer(channel)[i];
+                    REQUIRE(buffer3.getReadPointer(channel)[i] == Approx((a + b) * b));
+                }
+            }
+        }
+
+        SECTION("multiplyAdd") {
+            buffer3.copyFrom(buffer1);
+            buffer3.multiplyAdd(buffer1, buffer2);
+            for (size_t channel = 0; channel < 3; channel++) {
+                for (size_t i = 0; i < 22; i++) {
+                    float a = buffer1.getReadPointer(channel)[i];
+                    float b = buffer2.getReadPointer(channel)[i];
+                    REQUIRE(buffer3.getReadPointer(channel)[i] == Approx(a + a * b));
+                }
+            }
+        }
+
+        SECTION("addWithGain") {
+            buffer3.copyFrom(buffer1);
+            buffer3.addWithGain(buffer2, -2.0f);
+            for (size_t channel = 0; channel < 3; channel++) {
+                for (size_t i = 0; i < 22; i++) {
+                    float a = buffer1.getReadPointer(channel)[i];
+                    float b = buffer2.getReadPointer(channel)[i];
+                    REQUIRE(buffer3.getReadPointer(channel)[i] == Approx(a - 2.0f * b));
+                }
+            }
+        }
+    }
+
+    SECTION("expressions") {
+        AudioBuffer<float, 2, 10> a;
+        AudioBuffer<float, 2, 10> b;
+        AudioBuffer<float, 2, 10> c;
+        AudioBuffer<float, 2, 10> out;
+        for (size_t channel = 0; channel < 2; channel++) {
+            for (size_t i = 0; i < 10; i++) {
+                a.getWritePointer(channel)[i] = static_cast<float>(i) + channel;
+                b.getWritePointer(channel)[i] = 2.0f - static_cast<float>(i);
+                c.getWritePointer(channel)[i] = 0.5f * static_cast<float>(channel);
+            }
+        }
+
+        SECTION("fused evaluation") {
+            out = (a * b + c) * 0.5f;
+            for (size_t channel = 0; channel < 2; channel++) {
+                for (size_t i = 0; i < 10; i++) {
+                    float expected = (a.getReadPointer(channel)[i] * b.getReadPointer(channel)[i] +
+                                      c.getReadPointer(channel)[i]) * 0.5f;
+                    REQUIRE(out.getReadPointer(channel)[i] == Approx(expected));
+                }
+            }
+        }
+
+        SECTION("same result of the methods") {
+            out.copyFrom(a);
+            out.multiply(b);
+            out.add(c);
+            out.applyGain(0.5f);
+            AudioBuffer<float, 2, 10> fused;
+            fused = 0.5f * (c + a * b);
+            for (size_t channel = 0; channel < 2; channel++) {
+                for (size_t i = 0; i < 10; i++) {
+                    REQUIRE(fused.getReadPointer(channel)[i] == Approx(out.getReadPointer(channel)[i]));
+                }
+            }
+        }
+
+        SECTION("assigning an expression containing the destination") {
+            out.copyFrom(a);
+            out = out - a * 2;
+            for (size_t channel = 0; channel < 2; channel++) {
+                for (size_t i = 0; i < 10; i++) {
+                    REQUIRE(out.getReadPointer(channel)[i] == Approx(-a.getReadPointer(channel)[i]));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include "../include/audio_graph_scheduler.h"
+#include "../include/audio_graph.h"
+#include "../include/audio_processor.h"
+#include <memory>
+
+namespace {
+    class SchedulerTestProcessor : public AudioProcessor {
+    public:
+        explicit SchedulerTestProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+        void process() override {};
+    };
+
+    /**
+     * Adds a constant to its input, multiplies the result by a gain,
+     * and counts its calls.
+     */
+    class CountingModule : public AudioModule<2> {
+    public:
+        CountingModule(AudioProcessor &audioProcessor, float offset, float gain)
+                : AudioModule<2>(audioProcessor), offset(offset), gain(gain), calls(0) {};
+
+        void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+            calls++;
+            for (size_t c = 0; c < 2; c++) {
+                float *samples = buffer.getWritePointer(c);
+                for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                    samples[i] = (samples[i] + offset + c) * gain;
+                }
+            }
+        }
+
+        float offset;
+        float gain;
+        int calls;
+    };
+}
+
+TEST_CASE("AudioGraphScheduler", "[audio]") {
+    typedef AudioGraph<2, 16> Graph;
+    AudioDriver driver;
+    SchedulerTestProcessor processor(driver);
+
+    // four branches of three modules, fed by a common source and mixed together
+    CountingModule source(processor, 1.0f, 1.0f);
+    CountingModule mix(processor, 0.0f, 0.5f);
+    std::unique_ptr<CountingModule> branches[4][3];
+    for (int b = 0; b < 4; b++) {
+        for (int m = 0; m < 3; m++) {
+            branches[b][m].reset(new CountingModule(processor, static_cast<float>(b), 1.0f + 0.25f * m));
+        }
+    }
+    auto connect = [&](Graph &graph) {
+        const auto s = graph.add(source);
+        const auto x = graph.add(mix);
+        for (int b = 0; b < 4; b++) {
+            auto previous = s;
+            for (int m = 0; m < 3; m++) {
+                const auto node = graph.add(*branches[b][m]);
+                graph.connect(previous, node);
+                previous = node;
+            }
+            graph.connect(previous, x);
+        }
+        graph.setOutput(x);
+    };
+
+    Graph sequential;
+    connect(sequential);
+    REQUIRE(sequential.build());
+    AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> expected;
+    sequential.process(expected);
+
+    Graph parallel;
+    connect(parallel);
+    REQUIRE(parallel.build(true));
+    // the source, then a buffer per branch, processed in place down to the mix
+    REQUIRE(parallel.getBufferCount() == 5);
+
+    SECTION("parallel graph processed sequentially") {
+        AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> output;
+        parallel.process(output);
+        REQUIRE(output.getReadPointer(1)[3] == expected.getReadPointer(1)[3]);
+    }
+
+    for (size_t threads : {1, 2, 4}) {
+        SECTION("threads " + std::to_string(threads)) {
+            AudioGraphScheduler<Graph, 4> scheduler(parallel, threads, true, 64);
+            REQUIRE(scheduler.getThreadNumber() == threads);
+            const int callsBefore = source.calls;
+            AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> output;
+            for (int block = 0; block < 50; block++) {
+                output.clear();
+                scheduler.process(output);
+                for (size_t c = 0; c < 2; c++) {
+                    for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i += 17) {
+                        REQUIRE(output.getReadPointer(c)[i] == expected.getReadPointer(c)[i]);
+                    }
+                }
+            }
+            // each node runs once per block
+            REQUIRE(source.calls - callsBefore == 50);
+            REQUIRE(mix.calls - callsBefore == 50);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+#include "../include/audio_graph.h"
+#include "../include/audio_processor.h"
+
+namespace {
+    class GraphTestProcessor : public AudioProcessor {
+    public:
+        explicit GraphTestProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+        void process() override {};
+    };
+
+    /**
+     * Adds a constant to its input and multiplies the result by a gain.
+     */
+    class AffineModule : public AudioModule<1> {
+    public:
+        AffineModule(AudioProcessor &audioProcessor, float offset, float gain)
+                : AudioModule<1>(audioProcessor), offset(offset), gain(gain), calls(0) {};
+
+        void process(AudioBuffer<float, 1, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+            calls++;
+            float *samples = buffer.getWritePointer(0);
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                samples[i] = (samples[i] + offset) * gain;
+            }
+        }
+
+        float offset;
+        float gain;
+        int calls;
+    };
+}
+
+TEST_CASE("AudioGraph", "[audio]") {
+    AudioDriver driver;
+    GraphTestProcessor processor(driver);
+    AudioBuffer<float, 1, AUDIO_PROCESSOR_BLOCK_SIZE> output;
+
+    SECTION("chain") {
+        AudioGraph<1, 10> graph;
+        AffineModule source(processor, 1.0f, 1.0f);
+        AffineModule gain(processor, 0.0f, 3.0f);
+        AffineModule offset(processor, 2.0f, 1.0f);
+        // added in reverse order, the schedule follows the connections
+        const auto o = graph.add(offset);
+        const auto g = graph.add(gain);
+        const auto s = graph.add(source);
+        REQUIRE(graph.connect(s, g));
+        REQUIRE(graph.connect(g, o));
+        graph.setOutput(o);
+        REQUIRE(graph.build());
+        REQUIRE(graph.getScheduledNode(0) == s);
+        REQUIRE(graph.getScheduledNode(1) == g);
+        REQUIRE(graph.getScheduledNode(2) == o);
+        // the chain is processed in place
+        REQUIRE(graph.getBufferCount() == 1);
+
+        for (int block = 0; block < 2; block++) {
+            graph.process(output);
+            REQUIRE(output.getReadPointer(0)[0] == 5.0f);
+            REQUIRE(output.getReadPointer(0)[AUDIO_PROCESSOR_BLOCK_SIZE - 1] == 5.0f);
+        }
+        REQUIRE(source.calls == 2);
+    }
+
+    SECTION("fan out and mix") {
+        AudioGraph<1, 10> graph;
+        AffineModule source(processor, 1.0f, 1.0f);
+        AffineModule left(processor, 0.0f, 2.0f);
+        AffineModule right(processor, 0.0f, 10.0f);
+        AffineModule other(processor, 100.0f, 1.0f);
+        AffineModule mix(processor, 0.0f, 1.0f);
+        const auto s = graph.add(source);
+        const auto l = graph.add(left);
+        const auto r = graph.add(right);
+        const auto t = graph.add(other);
+        const auto m = graph.add(mix);
+        graph.connect(s, l);
+        graph.connect(s, r);
+        graph.connect(l, m);
+        graph.connect(r, m);
+        graph.connect(t, m);
+        graph.setOutput(m);
+        REQUIRE(graph.build());
+        graph.process(output);
+        REQUIRE(output.getReadPointer(0)[7] == 2.0f + 10.0f + 100.0f);
+        // the source is alive while both its readers run
+        REQUIRE(graph.getBufferCount() == 3);
+    }
+
+    SECTION("buffer reuse") {
+        // two chains of 3 mixed together, each chain needs a single buffer
+        AudioGraph<1, 8, 2> graph;
+        AffineModule a1(processor, 1.0f, 1.0f), a2(processor, 1.0f, 1.0f), a3(processor, 1.0f, 1.0f);
+        AffineModule b1(processor, 10.0f, 1.0f), b2(processor, 0.0f, 2.0f), b3(processor, 0.0f, 2.0f);
+        AffineModule mix(processor, 0.0f, 1.0f);
+        const auto na1 = graph.add(a1), na2 = graph.add(a2), na3 = graph.add(a3);
+        const auto nb1 = graph.add(b1), nb2 = graph.add(b2), nb3 = graph.add(b3);
+        const auto nm = graph.add(mix);
+        graph.connect(na1, na2);
+        graph.connect(na2, na3);
+        graph.connect(nb1, nb2);
+        graph.connect(nb2, nb3);
+        graph.connect(na3, nm);
+        graph.connect(nb3, nm);
+        graph.setOutput(nm);
+        REQUIRE(graph.build());
+        REQUIRE(graph.getBufferCount() == 2);
+        graph.process(output);
+        REQUIRE(output.getReadPointer(0)[0] == 3.0f + 40.0f);
+
+        SECTION("pool too small") {
+            AudioGraph<1, 8, 1> small;
+            const auto x = small.add(a1), y = small.add(b1), z = small.add(mix);
+            small.connect(x, z);
+            small.connect(y, z);
+            small.setOutput(z);
+            REQUIRE_FALSE(small.build());
+        }
+    }
+
+    SECTION("invalid graphs") {
+        AudioGraph<1, 2> graph;
+        AffineModule a(processor, 1.0f, 1.0f), b(processor, 1.0f, 1.0f), c(processor, 1.0f, 1.0f);
+        const auto na = graph.add(a);
+        const auto nb = graph.add(b);
+        REQUIRE(graph.add(c) == (AudioGraph<1, 2>::invalidId));
+        REQUIRE_FALSE(graph.connect(na, na));
+        REQUIRE_FALSE(graph.connect(na, 5));
+        REQUIRE_FALSE(graph.build());
+
+        graph.setOutput(nb);
+        REQUIRE(graph.connect(na, nb));
+        REQUIRE_FALSE(graph.connect(na, nb));
+        REQUIRE(graph.connect(nb, na));
+        // cycle
+        REQUIRE_FALSE(graph.build());
+        REQUIRE_FALSE(graph.isBuilt());
+        output.getWritePointer(0)[0] = 1.0f;
+        graph.process(output);
+        REQUIRE(output.getReadPointer(0)[0] == 0.0f);
+    }
+}
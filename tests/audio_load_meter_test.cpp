@@ -0,0 +1,169 @@
+#include "catch.hpp"
+#include "../include/audio_load_meter.h"
+#include "../include/audio_block_adapter.h"
+#include "../include/double_buffered_audio_driver.h"
+#include "../include/offline_audio_driver.h"
+#include "../include/audio_processor.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    /**
+     * Processable busy for a given time.
+     */
+    class BusyProcessable : public AudioProcessable {
+    public:
+        explicit BusyProcessable(double seconds) : seconds(seconds) {};
+
+        void process() override {
+            const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+            while (std::chrono::steady_clock::now() < end) {}
+        };
+
+        double seconds;
+    };
+
+    class LoadTestProcessor : public AudioProcessor {
+    public:
+        explicit LoadTestProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+        void process() override { getBuffer().clear(); };
+    };
+}
+
+TEST_CASE("AudioLoadMeter", "[audio]") {
+
+    SECTION("period") {
+        AudioLoadMeter meter(48000.0f);
+        REQUIRE(meter.getPeriod() == Approx(AUDIO_DRIVER_BUFFER_SIZE / 48000.0));
+        REQUIRE(meter.getCallbacks() == 0);
+        REQUIRE(meter.getLoad() == 0.0f);
+    }
+
+    SECTION("load, peak and overruns") {
+        AudioLoadMeter meter(AUDIO_DRIVER_SAMPLE_RATE, 0.0f);
+        BusyProcessable busy(0.0);
+        MeteredAudioProcessable metered(busy, meter);
+
+        // the busy wait can only last longer than requested
+        busy.seconds = 1.5 * meter.getPeriod();
+        metered.process();
+        REQUIRE(meter.getLoad() >= 1.5f);
+        REQUIRE(meter.getPeakLoad() == meter.getLoad());
+        REQUIRE(meter.getOverruns() == 1);
+
+        busy.seconds = 0.0;
+        metered.process();
+        REQUIRE(meter.getLoad() < meter.getPeakLoad());
+        // without averaging the average is the last load
+        REQUIRE(meter.getAverageLoad() == meter.getLoad());
+        REQUIRE(meter.getCallbacks() == 2);
+
+        REQUIRE(meter.resetPeakLoad() >= 1.5f);
+        REQUIRE(meter.getPeakLoad() == 0.0f);
+        metered.process();
+        REQUIRE(meter.getPeakLoad() == meter.getLoad());
+    }
+
+    SECTION("average") {
+        AudioLoadMeter meter(AUDIO_DRIVER_SAMPLE_RATE, 1.0f);
+        BusyProcessable busy(1.5 * meter.getPeriod());
+        MeteredAudioProcessable metered(busy, meter);
+        metered.process();
+        // a single callback moves the average by a small step
+        REQUIRE(meter.getAverageLoad() > 0.0f);
+        REQUIRE(meter.getAverageLoad() < 0.1f * meter.getLoad());
+    }
+
+    SECTION("blocks longer than the buffer") {
+        // one callback every 4 renders a block, with an average load of 0.5
+        const size_t blockSize = 4 * AUDIO_DRIVER_BUFFER_SIZE;
+        AudioLoadMeter meter(AUDIO_DRIVER_SAMPLE_RATE, 0.0f);
+        meter.setBlockSize(blockSize);
+        AudioBuffer<float, 2, AUDIO_DRIVER_BUFFER_SIZE> buffer;
+        AudioBlockAdapter<2, blockSize, AUDIO_DRIVER_BUFFER_SIZE> adapter(buffer);
+        BusyProcessable busy(2.0 * meter.getPeriod());
+        adapter.setBlockProcessable(busy);
+        MeteredAudioProcessable metered(adapter, meter);
+
+        for (int i = 0; i < 8; i++) metered.process();
+        REQUIRE(meter.getCallbacks() == 8);
+        REQUIRE(meter.getPeakLoad() >= 2.0f);
+        REQUIRE(meter.getOverruns() == 0);
+
+        // a block longer than its own period is an overrun
+        busy.seconds = 5.0 * meter.getPeriod();
+        for (int i = 0; i < 4; i++) metered.process();
+        REQUIRE(meter.getOverruns() == 1);
+
+        // the same callbacks overrun the period of a buffer-sized block
+        meter.setBlockSize(AUDIO_DRIVER_BUFFER_SIZE);
+        busy.seconds = 2.0 * meter.getPeriod();
+        for (int i = 0; i < 4; i++) metered.process();
+        REQUIRE(meter.getOverruns() == 2);
+    }
+
+    SECTION("reported xruns") {
+        AudioLoadMeter meter;
+        meter.reportXrun();
+        meter.reportXrun();
+        REQUIRE(meter.getXruns() == 2);
+        REQUIRE(meter.getOverruns() == 0);
+    }
+
+    SECTION("monitoring thread") {
+        AudioLoadMeter meter;
+        BusyProcessable busy(0.0);
+        MeteredAudioProcessable metered(busy, meter);
+        const uint32_t callbacks = 2000;
+        std::thread audioThread([&] {
+            for (uint32_t i = 0; i < callbacks; i++) metered.process();
+        });
+        float peak = 0.0f;
+        while (meter.getCallbacks() < callbacks) {
+            REQUIRE(meter.getLoad() >= 0.0f);
+            const float reset = meter.resetPeakLoad();
+            REQUIRE(reset >= 0.0f);
+            peak = (reset > peak) ? reset : peak;
+        }
+        audioThread.join();
+        REQUIRE(meter.getCallbacks() == callbacks);
+        // no load is lost by the resets: the last one is in a reset value or in the final peak
+        const float finalPeak = meter.getPeakLoad();
+        REQUIRE(((peak > finalPeak) ? peak : finalPeak) >= meter.getLoad());
+    }
+
+    SECTION("driver callback") {
+        const char *path = "audio_load_meter_test.wav";
+        const size_t blocks = 4;
+        OfflineAudioDriver driver(path, blocks);
+        LoadTestProcessor processor(driver);
+        REQUIRE(driver.init());
+        driver.setAudioProcessable(processor);
+        REQUIRE(driver.start());
+        std::remove(path);
+
+        const AudioLoadMeter &meter = driver.getLoadMeter();
+        REQUIRE(meter.getCallbacks() == blocks);
+        REQUIRE(meter.getPeriod() == Approx(AUDIO_DRIVER_BUFFER_SIZE / static_cast<double>(driver.getSampleRate())));
+        REQUIRE(meter.getPeakLoad() >= meter.getLoad());
+    }
+
+    SECTION("DMA xruns") {
+        DoubleBufferedAudioDriver<int16_t> driver;
+        LoadTestProcessor processor(driver);
+        driver.setAudioProcessable(processor);
+        driver.getOutputBuffer().reset();
+
+        // the second half is played before being rendered
+        driver.onHalfTransfer();
+        REQUIRE(driver.getXruns() == 1);
+        REQUIRE(driver.getLoadMeter().getXruns() == 1);
+
+        REQUIRE(driver.processPendingHalf());
+        driver.onTransferComplete();
+        REQUIRE(driver.getLoadMeter().getXruns() == driver.getXruns());
+        REQUIRE(driver.getLoadMeter().getCallbacks() >= 1);
+    }
+}
@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "../include/audio_math.h"
+#include <algorithm>
 #include <functional>
 
 TEST_CASE("linearInterpolation", "[audio]") {
@@ -117,4 +118,153 @@ TEST_CASE("LookupTable", "[audio]") {
             REQUIRE(linearZeroedLUT(testValue) == Approx(0.0));
         }
     }
-}
\ No newline at end of file
+
+    SECTION("constexpr LUT") {
+        static constexpr AudioMath::LookupTable<1024> sineLUT(AudioMath::LookupTableGenerator::Sine(),
+                                                              0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+        static constexpr AudioMath::LookupTable<1024> tanhLUT(AudioMath::LookupTableGenerator::Tanh(),
+                                                              -5, 5, AudioMath::LookupTableEdges::EXTENDED);
+        static_assert(sineLUT(0.0f) == 0.0f, "the table must be computed at compile time");
+
+        SECTION("values inside the table") {
+            testValue = GENERATE(-2.5, -1, 0, 1.2, 2.7, 4.0, 6.0);
+            REQUIRE(sineLUT(testValue) == Approx(std::sin(testValue)).margin(0.0001));
+            REQUIRE(tanhLUT(testValue) == Approx(std::tanh(testValue)).margin(0.0001));
+        }
+
+        SECTION("same content of the runtime constructor") {
+            auto f = [](float x) -> float { return std::sin(x); };
+            AudioMath::LookupTable<1024> runtimeLUT(std::function<float(float)>(f), 0, 2 * M_PI,
+                                                    AudioMath::LookupTableEdges::PERIODIC);
+            for (int i = 0; i < 1024; i++) {
+                testValue = static_cast<float>(2 * M_PI * i / 1024);
+                REQUIRE(sineLUT(testValue) == Approx(runtimeLUT(testValue)).margin(1e-6));
+            }
+        }
+
+        SECTION("constexpr functions") {
+            testValue = GENERATE(-20.0, -3.3, -0.1, 0.0, 0.7, 5.5, 31.0);
+            REQUIRE(AudioMath::Constexpr::sin(testValue) == Approx(std::sin(testValue)).margin(1e-6));
+            REQUIRE(AudioMath::Constexpr::exp(testValue / 4) == Approx(std::exp(testValue / 4)));
+            REQUIRE(AudioMath::Constexpr::tanh(testValue) == Approx(std::tanh(testValue)).margin(1e-6));
+        }
+    }
+
+    SECTION("block processing") {
+        auto f = [](float x) -> float { return std::sin(x) + 0.5f * x; };
+        auto edges = GENERATE(AudioMath::LookupTableEdges::ZEROED,
+                              AudioMath::LookupTableEdges::EXTENDED,
+                              AudioMath::LookupTableEdges::PERIODIC);
+        AudioMath::LookupTable<4096> lut(f, -2, 3, edges);
+
+        // values inside and outside the range, with a length that is
+        // not a multiple of the vector width
+        float input[203];
+        float output[203];
+        for (int i = 0; i < 203; i++) {
+            input[i] = -9.0f + 0.09f * i;
+        }
+        input[0] = -2.0f;
+        input[1] = 3.0f;
+        input[2] = 2.9999f;
+
+        lut.process(input, output, 203);
+        for (int i = 0; i < 203; i++) {
+            REQUIRE(output[i] == Approx(lut(input[i])).margin(0.0005));
+        }
+
+        SECTION("in place") {
+            lut.process(input, input, 203);
+            for (int i = 0; i < 203; i++) {
+                REQUIRE(input[i] == output[i]);
+            }
+        }
+    }
+
+    SECTION("constant time periodic wrapping") {
+        auto f = [](float x) -> float { return std::sin(x); };
+        AudioMath::LookupTable<1024> sineLUT(f, 0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+        testValue = GENERATE(-1e3, -7.5, 2 * M_PI, 20.0, 1e4);
+        const float wrapped = std::fmod(testValue, static_cast<float>(2 * M_PI));
+        REQUIRE(sineLUT(testValue) == Approx(std::sin(wrapped)).margin(0.002));
+        REQUIRE(std::isfinite(sineLUT(NAN)));
+        REQUIRE(std::isfinite(sineLUT(1e30f)));
+    }
+
+    SECTION("fixed point phase") {
+        auto f = [](float x) -> float { return std::sin(x); };
+        AudioMath::LookupTable<1024> sineLUT(f, 0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+
+        REQUIRE(AudioMath::FixedPointPhase::fromNormalized(0.25f).value == 0x40000000u);
+        REQUIRE(AudioMath::FixedPointPhase::fromNormalized(-0.25f).value == 0xC0000000u);
+        REQUIRE(AudioMath::FixedPointPhase::fromNormalized(1.5f).value == 0x80000000u);
+
+        SECTION("oscillator") {
+            const uint32_t increment = AudioMath::FixedPointPhase::increment(1000.0f, 44100.0f);
+            AudioMath::FixedPointPhase phase{0};
+            AudioMath::FixedPointPhase phases[300];
+            for (int i = 0; i < 300; i++) {
+                phases[i] = phase;
+                REQUIRE(sineLUT(phase) == Approx(std::sin(2 * M_PI * 1000.0 * i / 44100.0)).margin(0.0001));
+                phase += increment;
+            }
+
+            float output[300];
+            sineLUT.process(phases, output, 300);
+            for (int i = 0; i < 300; i++) {
+                REQUIRE(output[i] == sineLUT(phases[i]));
+            }
+        }
+    }
+
+    SECTION("higher order interpolation") {
+        auto f = [](float x) -> float { return std::sin(x); };
+        AudioMath::LookupTable<256> linearLUT(f, 0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+        AudioMath::LookupTable<256, AudioMath::LookupTableInterpolation::Hermite> hermiteLUT(
+                f, 0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+        static constexpr AudioMath::LookupTable<256, AudioMath::LookupTableInterpolation::Lagrange> lagrangeLUT(
+                AudioMath::LookupTableGenerator::Sine(), 0, 2 * M_PI, AudioMath::LookupTableEdges::PERIODIC);
+
+        // maximum error over a dense sweep, including the guard points at both ends
+        float input[1000];
+        float output[1000];
+        float linearError = 0, hermiteError = 0, lagrangeError = 0;
+        for (int i = 0; i < 1000; i++) {
+            input[i] = static_cast<float>(2 * M_PI * i / 999.0);
+            const float expected = std::sin(input[i]);
+            linearError = std::max(linearError, std::fabs(linearLUT(input[i]) - expected));
+            hermiteError = std::max(hermiteError, std::fabs(hermiteLUT(input[i]) - expected));
+            lagrangeError = std::max(lagrangeError, std::fabs(lagrangeLUT(input[i]) - expected));
+        }
+        REQUIRE(hermiteError < linearError / 4);
+        REQUIRE(lagrangeError < linearError / 50);
+        REQUIRE(lagrangeError < 2e-6);
+
+        SECTION("block processing") {
+            hermiteLUT.process(input, output, 1000);
+            for (int i = 0; i < 1000; i++) {
+                REQUIRE(output[i] == Approx(hermiteLUT(input[i])).margin(1e-5));
+            }
+            lagrangeLUT.process(input, output, 1000);
+            for (int i = 0; i < 1000; i++) {
+                REQUIRE(output[i] == Approx(lagrangeLUT(input[i])).margin(1e-5));
+            }
+        }
+
+        SECTION("guard points of the other edges") {
+            auto line = [](float x) -> float { return 2 * x + 1; };
+            AudioMath::LookupTable<8, AudioMath::LookupTableInterpolation::Lagrange> extendedLUT(
+                    line, 0, 8, AudioMath::LookupTableEdges::EXTENDED);
+            AudioMath::LookupTable<8, AudioMath::LookupTableInterpolation::Hermite> zeroedLUT(
+                    line, 0, 8, AudioMath::LookupTableEdges::ZEROED);
+            REQUIRE(extendedLUT(3.5f) == Approx(8.0f));
+            REQUIRE(extendedLUT(-1.0f) == Approx(1.0f));
+            REQUIRE(extendedLUT(5.5f) == Approx(12.0f));
+            REQUIRE(extendedLUT(9.0f) == Approx(15.0f));
+            REQUIRE(zeroedLUT(3.5f) == Approx(8.0f));
+            REQUIRE(zeroedLUT(9.0f) == 0.0f);
+            REQUIRE(zeroedLUT(-0.5f) == 0.0f);
+        }
+    }
+}
+
@@ -1,5 +1,8 @@
 #include "catch.hpp"
 #include "../include/audio_parameter.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
 
 TEST_CASE("AudioParameter", "[audio]") {
     AudioParameter<float> parameter(30.0);
@@ -49,4 +52,195 @@ TEST_CASE("AudioParameter", "[audio]") {
         REQUIRE(parameter.transitionIsComplete() == true);
         REQUIRE(parameter.getTransitionIndex() == Approx(1));
     }
+
+    SECTION("block ramps") {
+        AudioParameter<float> reference(30.0);
+        parameter.setTransitionSamples(100);
+        reference.setTransitionSamples(100);
+        parameter.setValue(60.0);
+        reference.setValue(60.0);
+
+        SECTION("fillRamp") {
+            // blocks crossing the end of the transition
+            float ramp[48];
+            for (int block = 0; block < 4; block++) {
+                parameter.fillRamp(ramp, 48);
+                for (int i = 0; i < 48; i++) {
+                    REQUIRE(ramp[i] == Approx(reference.getInterpolatedValue()));
+                    reference.updateSampleCount(1);
+                }
+                REQUIRE(parameter.getTransitionIndex() == Approx(reference.getTransitionIndex()));
+            }
+            REQUIRE(parameter.transitionIsComplete());
+        }
+
+        SECTION("applyRamp") {
+            AudioBuffer<float, 2, 64> buffer;
+            for (int block = 0; block < 3; block++) {
+                for (int channel = 0; channel < 2; channel++) {
+                    for (int i = 0; i < 64; i++) {
+                        buffer.getWritePointer(channel)[i] = channel + 1.0f;
+                    }
+                }
+                parameter.applyRamp(buffer);
+                for (int i = 0; i < 64; i++) {
+                    const float gain = reference.getInterpolatedValue();
+                    REQUIRE(buffer.getReadPointer(0)[i] == Approx(gain));
+                    REQUIRE(buffer.getReadPointer(1)[i] == Approx(2.0f * gain));
+                    reference.updateSampleCount(1);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("AtomicAudioParameter", "[audio]") {
+    AtomicAudioParameter<float> parameter(1.0f);
+    parameter.getParameter().setTransitionSamples(64);
+
+    SECTION("single thread") {
+        float ramp[32];
+        parameter.setValue(2.0f);
+        REQUIRE(parameter.getTargetValue() == 2.0f);
+        REQUIRE(parameter.getParameter().getValue() == 1.0f);
+
+        parameter.fillRamp(ramp, 32);
+        REQUIRE(ramp[0] == Approx(1.0f));
+        REQUIRE(ramp[31] == Approx(1.0f + 31.0f / 64.0f));
+
+        // the same value does not restart the transition
+        parameter.fillRamp(ramp, 32);
+        REQUIRE(parameter.getParameter().transitionIsComplete());
+        REQUIRE(ramp[31] == Approx(1.0f + 63.0f / 64.0f));
+    }
+
+    SECTION("updates from another thread") {
+        const int updates = 10000;
+        std::atomic<bool> done(false);
+
+        std::thread control([&] {
+            for (int i = 1; i <= updates; i++) {
+                parameter.setValue(static_cast<float>(i));
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        float ramp[16];
+        float previous = 1.0f;
+        bool finished = false;
+        while (!finished) {
+            finished = done.load(std::memory_order_acquire);
+            parameter.fillRamp(ramp, 16);
+            // the published values increase, so does the smoothed parameter
+            for (int i = 0; i < 16; i++) {
+                REQUIRE(ramp[i] >= previous - 1e-3f);
+                previous = ramp[i];
+            }
+        }
+        control.join();
+
+        for (int block = 0; block < 8; block++) {
+            parameter.fillRamp(ramp, 16);
+        }
+        REQUIRE(ramp[15] == static_cast<float>(updates));
+    }
+}
+
+template<typename Smoothing>
+void checkSmoothing(float from, float to) {
+    AudioParameter<float, Smoothing> parameter(from);
+    AudioParameter<float, Smoothing> reference(from);
+    parameter.setTransitionSamples(100);
+    reference.setTransitionSamples(100);
+    parameter.setValue(to);
+    reference.setValue(to);
+
+    // the block rendering follows the per sample interpolation
+    float ramp[48];
+    for (int block = 0; block < 3; block++) {
+        parameter.fillRamp(ramp, 48);
+        for (int i = 0; i < 48; i++) {
+            REQUIRE(ramp[i] == Approx(reference.getInterpolatedValue()).epsilon(1e-4).margin(1e-5));
+            reference.updateSampleCount(1);
+        }
+    }
+    REQUIRE(ramp[47] == to);
+    REQUIRE(parameter.getInterpolatedValue() == to);
+}
+
+TEST_CASE("AudioParameterSmoothing", "[audio]") {
+    SECTION("block rendering") {
+        checkSmoothing<AudioParameterSmoothing::Linear>(30.0f, 60.0f);
+        checkSmoothing<AudioParameterSmoothing::Exponential>(100.0f, 8000.0f);
+        checkSmoothing<AudioParameterSmoothing::Exponential>(-1.0f, 1.0f);
+        checkSmoothing<AudioParameterSmoothing::OnePole>(1.0f, 0.25f);
+        checkSmoothing<AudioParameterSmoothing::SCurve>(-2.0f, 2.0f);
+    }
+
+    SECTION("laws") {
+        // exponential: halfway is the geometric mean
+        REQUIRE(AudioParameterSmoothing::Exponential::interpolate(100.0f, 10000.0f, 0.5f) == Approx(1000.0f));
+
+        // one pole: the distance decays by a constant factor
+        REQUIRE(AudioParameterSmoothing::OnePole::interpolate(1.0f, 0.0f, 0.0f) == Approx(1.0f));
+        REQUIRE(AudioParameterSmoothing::OnePole::interpolate(1.0f, 0.0f, 0.5f) == Approx(std::sqrt(0.001f)));
+        REQUIRE(AudioParameterSmoothing::OnePole::interpolate(1.0f, 0.0f, 1.0f) == Approx(0.001f));
+
+        // s-curve: symmetric, with flat ends
+        REQUIRE(AudioParameterSmoothing::SCurve::interpolate(0.0f, 1.0f, 0.5f) == Approx(0.5f));
+        REQUIRE(AudioParameterSmoothing::SCurve::interpolate(0.0f, 1.0f, 0.01f) < 0.001f);
+        REQUIRE(AudioParameterSmoothing::SCurve::interpolate(0.0f, 1.0f, 0.99f) > 0.999f);
+    }
+}
+
+TEST_CASE("AudioParameterEventQueue", "[audio]") {
+    AudioParameterEventQueue<float, 4> events;
+
+    SECTION("sorted insertion") {
+        REQUIRE(events.push(30, 3.0f));
+        REQUIRE(events.push(10, 1.0f));
+        REQUIRE(events.push(30, 4.0f));
+        REQUIRE(events.push(20, 2.0f));
+        REQUIRE_FALSE(events.push(5, 0.0f));
+        REQUIRE(events.size() == 4);
+        for (size_t i = 0; i < 4; i++) {
+            REQUIRE(events[i].value == static_cast<float>(i + 1));
+        }
+
+        events.advance(25);
+        REQUIRE(events.size() == 2);
+        REQUIRE(events[0].offset == 5);
+        REQUIRE(events[1].offset == 5);
+    }
+
+    SECTION("sample accurate ramps") {
+        AudioParameter<float> parameter(0.0f);
+        AudioParameter<float> reference(0.0f);
+        parameter.setTransitionSamples(16);
+        reference.setTransitionSamples(16);
+
+        events.push(5, 1.0f);
+        events.push(40, -1.0f);
+        events.push(40, 2.0f);
+        events.push(70, 3.0f); // scheduled in the second block
+
+        float ramp[64];
+        for (size_t block = 0; block < 2; block++) {
+            parameter.fillRamp(ramp, 64, events);
+            for (size_t i = 0; i < 64; i++) {
+                const size_t sample = block * 64 + i;
+                if (sample == 5) reference.setValue(1.0f);
+                if (sample == 40) {
+                    reference.setValue(-1.0f);
+                    reference.setValue(2.0f);
+                }
+                if (sample == 70) reference.setValue(3.0f);
+                REQUIRE(ramp[i] == Approx(reference.getInterpolatedValue()).margin(1e-6));
+                reference.updateSampleCount(1);
+            }
+        }
+        REQUIRE(events.empty());
+        REQUIRE(parameter.getValue() == 3.0f);
+    }
 }
+
@@ -0,0 +1,169 @@
+#include "catch.hpp"
+#include "../include/audio_pcm.h"
+#include <cmath>
+#include <cstdlib>
+
+TEST_CASE("AudioPcm", "[audio]") {
+    // odd length to cover the scalar tail of the vectorized kernels
+    const size_t n = 37;
+    float left[n];
+    float right[n];
+    for (size_t i = 0; i < n; i++) {
+        left[i] = -1.5f + 3.0f * static_cast<float>(i) / (n - 1);
+        right[i] = 0.9f * std::sin(0.37f * i);
+    }
+
+    SECTION("16 bit") {
+        int16_t output[2 * n];
+        AudioPcm::interleave(output, left, right, n);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(output[2 * i] == AudioPcm::quantize(left[i], 32767.0f));
+            REQUIRE(output[2 * i + 1] == AudioPcm::quantize(right[i], 32767.0f));
+            // the product is rounded to float before the rounding to integer
+            REQUIRE(std::abs(output[2 * i + 1] - right[i] * 32767.0) <= 0.75);
+        }
+        REQUIRE(output[0] == -32767);
+        REQUIRE(output[2 * (n - 1)] == 32767);
+    }
+
+    SECTION("24 bit") {
+        int32_t output[2 * n];
+        AudioPcm::interleave(output, left, right, n, 24);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(output[2 * i] == AudioPcm::quantize(left[i], 8388607.0f));
+            REQUIRE(output[2 * i + 1] == AudioPcm::quantize(right[i], 8388607.0f));
+            REQUIRE(std::abs(output[2 * i + 1] - right[i] * 8388607.0) <= 0.75);
+        }
+        REQUIRE(output[0] == -8388607);
+        REQUIRE(output[2 * (n - 1)] == 8388607);
+    }
+
+    SECTION("32 bit") {
+        int32_t output[2 * n];
+        AudioPcm::interleave(output, left, right, n, 32);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(output[2 * i] == AudioPcm::quantize(left[i], AudioPcm::maxValue(32)));
+            REQUIRE(output[2 * i + 1] == Approx(right[i] * 2147483647.0).margin(256));
+        }
+        // full scale does not overflow
+        REQUIRE(output[0] < -2147483000);
+        REQUIRE(output[2 * (n - 1)] > 2147483000);
+    }
+}
+
+TEST_CASE("AudioPcm halves", "[audio]") {
+    // exact halves, rounded away from zero both by the vectorized body and by the scalar tail
+    const size_t n = 37;
+    float left[n];
+    float right[n];
+    for (size_t i = 0; i < n; i++) {
+        const float value = static_cast<float>(i % 4) + 0.5f;
+        left[i] = value / 32767.0f;
+        right[i] = -value / 32767.0f;
+    }
+
+    SECTION("16 bit") {
+        int16_t output[2 * n];
+        AudioPcm::interleave(output, left, right, n);
+        for (size_t i = 0; i < n; i++) {
+            const int expected = static_cast<int>(i % 4) + 1;
+            REQUIRE(output[2 * i] == expected);
+            REQUIRE(output[2 * i + 1] == -expected);
+        }
+    }
+
+    SECTION("24 bit") {
+        int32_t output[2 * n];
+        const float scale = AudioPcm::maxValue(24);
+        for (size_t i = 0; i < n; i++) {
+            const float value = static_cast<float>(i % 4) + 0.5f;
+            left[i] = value / scale;
+            right[i] = -value / scale;
+        }
+        AudioPcm::interleave(output, left, right, n, 24);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(output[2 * i] == AudioPcm::quantize(left[i], scale));
+            REQUIRE(output[2 * i + 1] == AudioPcm::quantize(right[i], scale));
+            REQUIRE(output[2 * i] == static_cast<int>(i % 4) + 1);
+        }
+    }
+    SECTION("just below the halves") {
+        REQUIRE(AudioPcm::round(0.49999997f) == 0);
+        REQUIRE(AudioPcm::round(-0.49999997f) == 0);
+        REQUIRE(AudioPcm::round(2.4999998f) == 2);
+
+        // the largest samples whose product by the scale is below the half
+        for (size_t i = 0; i < n; i++) {
+            const float value = static_cast<float>(i % 4) + 0.5f;
+            float x = value / 32767.0f;
+            while (x * 32767.0f >= value) x = std::nextafter(x, 0.0f);
+            left[i] = x;
+            right[i] = -x;
+        }
+        int16_t output[2 * n];
+        AudioPcm::interleave(output, left, right, n);
+        for (size_t i = 0; i < n; i++) {
+            const int expected = static_cast<int>(i % 4);
+            REQUIRE(output[2 * i] == expected);
+            REQUIRE(output[2 * i + 1] == -expected);
+        }
+    }
+}
+
+TEST_CASE("PcmConverter", "[audio]") {
+    const size_t n = 4096;
+    static float left[n];
+    static float right[n];
+    static int16_t output[2 * n];
+    for (size_t i = 0; i < n; i++) {
+        // a constant between two quantization steps
+        left[i] = 100.3f / 32767.0f;
+        right[i] = -left[i];
+    }
+
+    SECTION("no dither") {
+        PcmConverter converter;
+        converter.convert(output, left, right, n);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(output[2 * i] == 100);
+            REQUIRE(output[2 * i + 1] == -100);
+        }
+    }
+
+    SECTION("TPDF dither") {
+        PcmConverter converter(PcmDither::TPDF);
+        converter.convert(output, left, right, n);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE(std::abs(output[2 * i] - 100.3f) <= 1.5f);
+            REQUIRE(std::abs(output[2 * i + 1] + 100.3f) <= 1.5f);
+            sum += output[2 * i];
+        }
+        // the dither preserves the value below the quantization step on average
+        REQUIRE(sum / n == Approx(100.3).margin(0.05));
+    }
+
+    SECTION("noise shaping") {
+        PcmConverter converter(PcmDither::NOISE_SHAPED);
+        int32_t wideOutput[2 * 64];
+        double error = 0.0;
+        for (size_t block = 0; block < n / 64; block++) {
+            converter.convert(wideOutput, left + block * 64, right + block * 64, 64, 16);
+            for (size_t i = 0; i < 64; i++) {
+                // the shaped error is the difference of consecutive errors,
+                // so its sum, the low frequency content, stays bounded
+                error += wideOutput[2 * i] - 100.3;
+                REQUIRE(std::abs(error) < 2.5);
+            }
+        }
+    }
+
+    SECTION("clipping") {
+        PcmConverter converter(PcmDither::TPDF);
+        left[0] = 2.0f;
+        right[0] = -2.0f;
+        converter.convert(output, left, right, 1);
+        REQUIRE(output[0] == 32767);
+        REQUIRE(output[1] == -32767);
+    }
+}
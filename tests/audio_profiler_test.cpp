@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include "../include/audio_profiler.h"
+#include "../include/audio_graph.h"
+#include "../include/audio_processor.h"
+#include <thread>
+
+namespace {
+    class ProfilerTestProcessor : public AudioProcessor {
+    public:
+        explicit ProfilerTestProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+        void process() override { calls++; };
+
+        int calls = 0;
+    };
+
+    class ProfilerTestModule : public AudioModule<1> {
+    public:
+        explicit ProfilerTestModule(AudioProcessor &audioProcessor) : AudioModule<1>(audioProcessor) {};
+
+        void process(AudioBuffer<float, 1, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+            calls++;
+            buffer.applyGain(2.0f);
+        }
+
+        int calls = 0;
+    };
+}
+
+TEST_CASE("AudioProfiler", "[audio]") {
+    AudioProfileSnapshot snapshot;
+
+    SECTION("buckets") {
+        const size_t bucketNumber = AudioProfileSnapshot::bucketNumber;
+        for (uint32_t ticks : {0u, 3u, 4u, 5u, 7u, 8u, 100u, 1000u, 123456u, UINT32_MAX}) {
+            const size_t bucket = AudioProfileSnapshot::getBucket(ticks);
+            REQUIRE(bucket < bucketNumber);
+            REQUIRE(ticks <= AudioProfileSnapshot::getBucketUpperBound(bucket));
+            if (bucket > 0) REQUIRE(ticks > AudioProfileSnapshot::getBucketUpperBound(bucket - 1));
+        }
+        REQUIRE(AudioProfileSnapshot::getBucketUpperBound(AudioProfileSnapshot::getBucket(UINT32_MAX)) == UINT32_MAX);
+    }
+
+    SECTION("statistics") {
+        AudioProfileSlot slot;
+        slot.getSnapshot(snapshot);
+        REQUIRE(snapshot.count == 0);
+        REQUIRE(snapshot.getMean() == 0.0);
+        REQUIRE(snapshot.getPercentile(0.5f) == 0);
+
+        for (uint32_t ticks = 1; ticks <= 100; ticks++) slot.record(ticks * 10);
+        slot.getSnapshot(snapshot);
+        REQUIRE(snapshot.count == 100);
+        REQUIRE(snapshot.minimum == 10);
+        REQUIRE(snapshot.maximum == 1000);
+        REQUIRE(snapshot.getMean() == Approx(505.0));
+        // within the resolution of the histogram
+        REQUIRE(snapshot.getPercentile(0.5f) >= 500);
+        REQUIRE(snapshot.getPercentile(0.5f) <= 625);
+        REQUIRE(snapshot.getPercentile(0.99f) >= 990);
+        REQUIRE(snapshot.getPercentile(0.99f) <= 1000);
+        REQUIRE(snapshot.getPercentile(0.0f) == 10);
+        REQUIRE(snapshot.getPercentile(1.0f) == 1000);
+    }
+
+    SECTION("total beyond 32 bits") {
+        AudioProfileSlot slot;
+        for (int i = 0; i < 4; i++) slot.record(UINT32_MAX);
+        slot.getSnapshot(snapshot);
+        REQUIRE(snapshot.total == 4 * static_cast<uint64_t>(UINT32_MAX));
+        REQUIRE(snapshot.getMean() == Approx(UINT32_MAX));
+    }
+
+    SECTION("reset") {
+        AudioProfileSlot slot;
+        slot.record(50);
+        slot.reset();
+        slot.getSnapshot(snapshot);
+        REQUIRE(snapshot.count == 0);
+        // applied by the writer at the next record
+        slot.record(7);
+        slot.getSnapshot(snapshot);
+        REQUIRE(snapshot.count == 1);
+        REQUIRE(snapshot.minimum == 7);
+        REQUIRE(snapshot.maximum == 7);
+    }
+
+    SECTION("profiler") {
+        AudioProfiler<2> profiler;
+        AudioProfileSlot *first = profiler.add("first");
+        AudioProfileSlot *second = profiler.add("second");
+        REQUIRE(profiler.add("third") == nullptr);
+        REQUIRE(profiler.size() == 2);
+        REQUIRE(&profiler.getSlot(1) == second);
+        REQUIRE(std::string(profiler.getSlot(0).getName()) == "first");
+
+        first->record(1);
+        second->record(2);
+        profiler.reset();
+        profiler.getSlot(0).getSnapshot(snapshot);
+        REQUIRE(snapshot.count == 0);
+    }
+
+    SECTION("profiled module and processor") {
+        AudioDriver driver;
+        ProfilerTestProcessor processor(driver);
+        ProfilerTestModule module(processor);
+        AudioProfiler<> profiler;
+        ProfiledAudioModule<1> profiledModule(processor, module, profiler.add("module"));
+        ProfiledAudioProcessable profiledProcessor(processor, profiler.add("processor"));
+
+        AudioGraph<1, 2> graph;
+        graph.setOutput(graph.add(profiledModule));
+        REQUIRE(graph.build());
+        AudioBuffer<float, 1, AUDIO_PROCESSOR_BLOCK_SIZE> output;
+        for (int block = 0; block < 3; block++) {
+            graph.process(output);
+            profiledProcessor.process();
+        }
+        REQUIRE(module.calls == 3);
+        REQUIRE(processor.calls == 3);
+
+        const uint32_t expected = AUDIO_PROFILING ? 3 : 0;
+        profiler.getSlot(0).getSnapshot(snapshot);
+        REQUIRE(snapshot.count == expected);
+        REQUIRE(snapshot.minimum <= snapshot.maximum);
+        profiler.getSlot(1).getSnapshot(snapshot);
+        REQUIRE(snapshot.count == expected);
+    }
+
+    SECTION("concurrent snapshots") {
+        AudioProfileSlot slot;
+        const uint32_t records = 20000;
+        std::thread writer([&] {
+            for (uint32_t i = 0; i < records; i++) slot.record(100 + i % 2);
+        });
+        uint32_t lastCount = 0;
+        while (lastCount < records) {
+            slot.getSnapshot(snapshot);
+            // a snapshot is always consistent
+            uint64_t histogramCount = 0;
+            for (uint32_t bucket : snapshot.histogram) histogramCount += bucket;
+            REQUIRE(histogramCount == snapshot.count);
+            REQUIRE(snapshot.count >= lastCount);
+            if (snapshot.count > 0) {
+                REQUIRE(snapshot.minimum == 100);
+                REQUIRE(snapshot.total >= 100 * static_cast<uint64_t>(snapshot.count));
+            }
+            lastCount = snapshot.count;
+        }
+        writer.join();
+    }
+}
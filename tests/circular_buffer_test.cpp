@@ -1,5 +1,8 @@
 #include "catch.hpp"
 #include "../include/circular_buffer.h"
+#include "../include/audio_buffer.h"
+#include <thread>
+#include <vector>
 
 TEST_CASE("CircularBuffer", "[containers]") {
 
@@ -167,4 +170,240 @@ TEST_CASE("CircularBuffer", "[containers]") {
         };
 
     }
+
+    SECTION("SPSC CircularBuffer test") {
+        SECTION("single thread") {
+            CircularBuffer<int, 4, CircularBufferType::SPSC> buffer;
+            REQUIRE(buffer.empty() == true);
+            REQUIRE(buffer.max_size() == 4);
+
+            REQUIRE(buffer.push(1) == true);
+            REQUIRE(buffer.push(2) == true);
+            REQUIRE(buffer.push(3) == true);
+            REQUIRE(buffer.push(4) == true);
+            REQUIRE(buffer.push(5) == false);
+            REQUIRE(buffer.size() == 4);
+
+            REQUIRE(buffer.front() == 1);
+            REQUIRE(buffer.pop() == true);
+            REQUIRE(buffer.push(6) == true);
+            REQUIRE(buffer.size() == 4);
+
+            // wrapping around the indices more than once
+            for (int i = 7; i < 20; i++) {
+                REQUIRE(buffer.pop() == true);
+                REQUIRE(buffer.push(i) == true);
+            }
+            REQUIRE(buffer.front() == 16);
+
+            buffer.clear();
+            REQUIRE(buffer.empty() == true);
+            REQUIRE(buffer.pop() == false);
+        }
+
+        SECTION("producer and consumer threads") {
+            const int itemCount = 200000;
+            CircularBuffer<int, 64, CircularBufferType::SPSC> buffer;
+            bool ordered = true;
+
+            std::thread producer([&] {
+                for (int i = 0; i < itemCount; i++) {
+                    while (!buffer.push(i)) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+
+            std::thread consumer([&] {
+                int expected = 0;
+                while (expected < itemCount) {
+                    if (buffer.empty()) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    if (buffer.front() != expected) ordered = false;
+                    buffer.pop();
+                    expected++;
+                }
+            });
+
+            producer.join();
+            consumer.join();
+            REQUIRE(ordered == true);
+            REQUIRE(buffer.empty() == true);
+        }
+    }
+
+    SECTION("Block operations") {
+        int items[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+        int output[10] = {};
+
+        SECTION("write and read with wrapping") {
+            CircularBuffer<int, 8, CircularBufferType::Discard> buffer;
+            REQUIRE(buffer.write(items, 6) == 6);
+            REQUIRE(buffer.read(output, 4) == 4);
+            REQUIRE(buffer.write(items + 6, 4) == 4);
+            REQUIRE(buffer.size() == 6);
+            REQUIRE(buffer.read(output, 10) == 6);
+            for (int i = 0; i < 6; i++) {
+                REQUIRE(output[i] == i + 4);
+            }
+            REQUIRE(buffer.empty() == true);
+        }
+
+        SECTION("discarding on overflow") {
+            CircularBuffer<int, 8, CircularBufferType::Discard> buffer;
+            REQUIRE(buffer.write(items, 10) == 8);
+            REQUIRE(buffer.front() == 0);
+            REQUIRE(buffer.back() == 7);
+        }
+
+        SECTION("overwriting on overflow") {
+            CircularBuffer<int, 8, CircularBufferType::Overwrite> buffer;
+            buffer.write(items, 5);
+            buffer.write(items + 5, 5);
+            REQUIRE(buffer.size() == 8);
+            REQUIRE(buffer.front() == 2);
+            REQUIRE(buffer.back() == 9);
+
+            buffer.clear();
+            REQUIRE(buffer.write(items, 10) == 8);
+            REQUIRE(buffer.front() == 2);
+            buffer.pop();
+            buffer.push(10);
+            REQUIRE(buffer.back() == 10);
+        }
+
+        SECTION("mixing single and block operations") {
+            CircularBuffer<int, 8, CircularBufferType::Overwrite> buffer;
+            for (int i = 0; i < 7; i++) {
+                buffer.push(i);
+            }
+            for (int i = 0; i < 5; i++) {
+                buffer.pop();
+            }
+            buffer.write(items + 7, 3);
+            int i = 0;
+            int expected[5] = {5, 6, 7, 8, 9};
+            for (auto item : buffer) {
+                REQUIRE(item == expected[i++]);
+            }
+            REQUIRE(i == 5);
+        }
+
+        SECTION("prepare and commit") {
+            CircularBuffer<int, 8, CircularBufferType::Discard> buffer;
+            buffer.write(items, 6);
+            buffer.read(output, 6);
+
+            // the free space wraps around the end of the underlying buffer
+            auto regions = buffer.prepare_write(5);
+            REQUIRE(regions.size() == 5);
+            REQUIRE(regions.second.size > 0);
+            std::copy(items, items + regions.first.size, regions.first.data);
+            std::copy(items + regions.first.size, items + 5, regions.second.data);
+            buffer.commit_write(5);
+            REQUIRE(buffer.size() == 5);
+
+            auto readRegions = buffer.prepare_read(8);
+            REQUIRE(readRegions.size() == 5);
+            REQUIRE(readRegions.first.data[0] == 0);
+            REQUIRE(readRegions.second.data[readRegions.second.size - 1] == 4);
+            buffer.commit_read(3);
+            REQUIRE(buffer.front() == 3);
+        }
+
+        SECTION("streaming an AudioBuffer channel") {
+            AudioBuffer<float, 2, 16> input;
+            AudioBuffer<float, 2, 16> output;
+            for (int i = 0; i < 16; i++) {
+                input.getWritePointer(1)[i] = static_cast<float>(i);
+            }
+            CircularBuffer<float, 24, CircularBufferType::Discard> buffer;
+            for (int block = 0; block < 4; block++) {
+                REQUIRE(buffer.write(input.getReadPointer(1), 16) == 16);
+                REQUIRE(buffer.read(output.getWritePointer(0), 16) == 16);
+                REQUIRE(output.getBufferContainer()[0] == input.getBufferContainer()[1]);
+            }
+        }
+
+        SECTION("SPSC block transfer between threads") {
+            const int blockCount = 5000;
+            const int blockLength = 48;
+            CircularBuffer<int, 128, CircularBufferType::SPSC> buffer;
+            bool ordered = true;
+
+            std::thread producer([&] {
+                int block[blockLength];
+                int next = 0;
+                while (next < blockCount * blockLength) {
+                    for (int i = 0; i < blockLength; i++) {
+                        block[i] = next + i;
+                    }
+                    int written = static_cast<int>(buffer.write(block, blockLength));
+                    next += written;
+                    if (written < blockLength) {
+                        // retrying from the first element that was not written
+                        while (written < blockLength) {
+                            std::this_thread::yield();
+                            int chunk = static_cast<int>(buffer.write(block + written, blockLength - written));
+                            written += chunk;
+                            next += chunk;
+                        }
+                    }
+                }
+            });
+
+            std::thread consumer([&] {
+                int block[blockLength];
+                int expected = 0;
+                while (expected < blockCount * blockLength) {
+                    int read = static_cast<int>(buffer.read(block, blockLength));
+                    if (read == 0) std::this_thread::yield();
+                    for (int i = 0; i < read; i++) {
+                        if (block[i] != expected++) ordered = false;
+                    }
+                }
+            });
+
+            producer.join();
+            consumer.join();
+            REQUIRE(ordered == true);
+            REQUIRE(buffer.empty() == true);
+        }
+    }
+
+    SECTION("Indexing policies") {
+        // the same sequence of operations on the two indexing policies
+        CircularBuffer<int, 8, CircularBufferType::Overwrite, CircularBufferIndexing::Generic<8>> generic;
+        CircularBuffer<int, 8, CircularBufferType::Overwrite, CircularBufferIndexing::PowerOfTwo<8>> powerOfTwo;
+        int block[5] = {100, 101, 102, 103, 104};
+        int value = 0;
+        for (int step = 0; step < 50; step++) {
+            for (int i = 0; i < step % 4; i++) {
+                generic.push(value);
+                powerOfTwo.push(value);
+                value++;
+            }
+            if (step % 5 == 0) {
+                generic.write(block, 5);
+                powerOfTwo.write(block, 5);
+            }
+            for (int i = 0; i < step % 3; i++) {
+                generic.pop();
+                powerOfTwo.pop();
+            }
+
+            REQUIRE(generic.size() == powerOfTwo.size());
+            auto it = powerOfTwo.begin();
+            for (auto item : generic) {
+                REQUIRE(item == *it);
+                ++it;
+            }
+            if (!generic.empty()) {
+                REQUIRE(generic.front() == powerOfTwo.front());
+                REQUIRE(generic.back() == powerOfTwo.back());
+            }
+        }
+    }
 }
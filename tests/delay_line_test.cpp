@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "../include/delay_line.h"
+#include <cmath>
+
+TEST_CASE("DelayLine", "[audio]") {
+    float input[64];
+    float output[64];
+    float delays[64];
+    for (int i = 0; i < 64; i++) {
+        input[i] = static_cast<float>(i);
+    }
+
+    SECTION("ring size") {
+        REQUIRE(DelayLine<float, 100, DelayLineInterpolation::Linear, 32>::ringSize == 256);
+        REQUIRE(DelayLine<float, 30, DelayLineInterpolation::Linear, 32>::ringSize == 64);
+    }
+
+    SECTION("integer delay") {
+        DelayLine<float, 16, DelayLineInterpolation::Linear, 16> line;
+        line.process(input, output, 3.0f, 64);
+        for (int i = 0; i < 64; i++) {
+            REQUIRE(output[i] == Approx(i < 3 ? 0.0f : i - 3.0f));
+        }
+    }
+
+    SECTION("linear interpolation") {
+        DelayLine<float, 16, DelayLineInterpolation::Linear, 16> line;
+        line.process(input, output, 2.25f, 64);
+        for (int i = 3; i < 64; i++) {
+            REQUIRE(output[i] == Approx(i - 2.25f));
+        }
+    }
+
+    SECTION("lagrange interpolation") {
+        // a cubic polynomial is reconstructed exactly
+        auto f = [](float x) { return 0.001f * x * x * x - 0.02f * x * x + 0.5f * x; };
+        for (int i = 0; i < 64; i++) {
+            input[i] = f(static_cast<float>(i));
+        }
+        DelayLine<float, 16, DelayLineInterpolation::Lagrange3, 16> line;
+        line.process(input, output, 4.7f, 64);
+        for (int i = 8; i < 64; i++) {
+            REQUIRE(output[i] == Approx(f(i - 4.7f)).margin(1e-3));
+        }
+
+        SECTION("minimum delay") {
+            DelayLine<float, 16, DelayLineInterpolation::Lagrange3, 16> line2;
+            line2.process(input, output, 0.0f, 64);
+            for (int i = 1; i < 64; i++) {
+                REQUIRE(output[i] == Approx(input[i - 1]));
+            }
+        }
+    }
+
+    SECTION("allpass interpolation") {
+        DelayLine<float, 16, DelayLineInterpolation::Allpass, 16> line;
+        line.process(input, output, 5.5f, 64);
+        for (int i = 20; i < 64; i++) {
+            // a ramp is delayed exactly once the transient is over
+            REQUIRE(output[i] == Approx(i - 5.5f).margin(1e-3));
+        }
+    }
+
+    SECTION("maximum delay") {
+        DelayLine<float, 8, DelayLineInterpolation::Linear, 16> line;
+        line.process(input, output, 20.0f, 64);
+        for (int i = 8; i < 64; i++) {
+            REQUIRE(output[i] == Approx(i - 8.0f));
+        }
+    }
+
+    SECTION("modulated delays on an AudioBuffer") {
+        DelayLine<float, 32, DelayLineInterpolation::Linear, 16> line;
+        DelayLine<float, 32, DelayLineInterpolation::Linear, 16> reference;
+        AudioBuffer<float, 2, 16> buffer;
+        for (int block = 0; block < 4; block++) {
+            for (int i = 0; i < 16; i++) {
+                buffer.getWritePointer(1)[i] = input[block * 16 + i];
+                delays[i] = 8.0f + 4.0f * std::sin(0.3f * (block * 16 + i));
+            }
+            line.process(buffer, 1, delays);
+
+            for (int i = 0; i < 16; i++) {
+                // reference computed one sample at a time
+                reference.write(&input[block * 16 + i], 1);
+                float expected = reference.read(delays[i]);
+                REQUIRE(buffer.getReadPointer(1)[i] == Approx(expected));
+                if (block > 0) {
+                    REQUIRE(expected == Approx(block * 16 + i - delays[i]));
+                }
+            }
+        }
+    }
+}
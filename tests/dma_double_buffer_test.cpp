@@ -0,0 +1,101 @@
+#include "catch.hpp"
+#include "../include/dma_double_buffer.h"
+
+TEST_CASE("DmaDoubleBuffer", "[audio]") {
+    typedef DmaDoubleBuffer<int16_t, 8> Buffer;
+    Buffer buffer;
+    REQUIRE(Buffer::size() == 16);
+    REQUIRE(buffer.getState(0) == Buffer::PLAYING);
+    REQUIRE(buffer.getState(1) == Buffer::FREE);
+
+    SECTION("ping-pong") {
+        for (int period = 0; period < 4; period++) {
+            // the half that is not playing is rendered
+            const size_t free = (period % 2 == 0) ? 1 : 0;
+            int16_t *half = buffer.acquire();
+            REQUIRE(half == buffer.data() + free * 8);
+            REQUIRE(buffer.acquire() == nullptr);
+            for (int i = 0; i < 8; i++) half[i] = static_cast<int16_t>(period);
+            buffer.release();
+            REQUIRE(buffer.getState(free) == Buffer::READY);
+
+            Buffer::HalfState state = (free == 1) ? buffer.halfTransferComplete() : buffer.transferComplete();
+            REQUIRE(state == Buffer::READY);
+            REQUIRE(buffer.getState(free) == Buffer::PLAYING);
+            REQUIRE(buffer.getState(1 - free) == Buffer::FREE);
+        }
+        REQUIRE(buffer.getXruns() == 0);
+    }
+
+    SECTION("late processing replays the old half") {
+        REQUIRE(buffer.halfTransferComplete() == Buffer::FREE);
+        REQUIRE(buffer.getXruns() == 1);
+        REQUIRE(buffer.getState(1) == Buffer::PLAYING);
+
+        // the processing renders the first half, without touching the playing one
+        REQUIRE(buffer.acquire() == buffer.data());
+        buffer.release();
+        REQUIRE(buffer.transferComplete() == Buffer::READY);
+        REQUIRE(buffer.getXruns() == 1);
+    }
+
+    SECTION("a half still being written is dropped") {
+        REQUIRE(buffer.acquire() == buffer.data() + 8);
+        REQUIRE(buffer.halfTransferComplete() == Buffer::WRITING);
+        REQUIRE(buffer.getState(1) == Buffer::TORN);
+        REQUIRE(buffer.getXruns() == 1);
+
+        // released while being played, the half is freed at the end of its period
+        buffer.release();
+        REQUIRE(buffer.getState(1) == Buffer::PLAYING);
+        REQUIRE(buffer.transferComplete() == Buffer::FREE);
+        REQUIRE(buffer.getState(1) == Buffer::FREE);
+        REQUIRE(buffer.getXruns() == 2);
+    }
+
+    SECTION("a half written past its period is dropped") {
+        REQUIRE(buffer.acquire() == buffer.data() + 8);
+        REQUIRE(buffer.halfTransferComplete() == Buffer::WRITING);
+        REQUIRE(buffer.transferComplete() == Buffer::FREE);
+        REQUIRE(buffer.getState(1) == Buffer::STALE);
+
+        buffer.release();
+        REQUIRE(buffer.getState(1) == Buffer::FREE);
+        REQUIRE(buffer.acquire() == buffer.data() + 8);
+        buffer.release();
+        REQUIRE(buffer.halfTransferComplete() == Buffer::READY);
+        REQUIRE(buffer.getXruns() == 2);
+    }
+
+    SECTION("a late block is never played after a newer one") {
+        // block A is late and torn
+        int16_t *a = buffer.acquire();
+        REQUIRE(a == buffer.data() + 8);
+        REQUIRE(buffer.halfTransferComplete() == Buffer::WRITING);
+        for (int i = 0; i < 8; i++) a[i] = 1;
+        buffer.release();
+
+        // block B is rendered in time into the other half
+        int16_t *b = buffer.acquire();
+        REQUIRE(b == buffer.data());
+        for (int i = 0; i < 8; i++) b[i] = 2;
+        buffer.release();
+        REQUIRE(buffer.acquire() == nullptr);
+
+        // B is played, then A is not played as a new block
+        REQUIRE(buffer.transferComplete() == Buffer::READY);
+        REQUIRE(buffer.getState(0) == Buffer::PLAYING);
+        REQUIRE(buffer.halfTransferComplete() == Buffer::FREE);
+        REQUIRE(buffer.getXruns() == 2);
+    }
+
+    SECTION("reset") {
+        buffer.acquire()[0] = 5;
+        buffer.halfTransferComplete();
+        buffer.reset();
+        REQUIRE(buffer.data()[8] == 0);
+        REQUIRE(buffer.getXruns() == 0);
+        REQUIRE(buffer.getState(0) == Buffer::PLAYING);
+        REQUIRE(buffer.getState(1) == Buffer::FREE);
+    }
+}
@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include "../include/offline_audio_driver.h"
+#include "../include/audio_processor.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Processor writing a known sequence: the left channel counts
+ * the samples, the right one is a constant out of range value.
+ */
+class CounterProcessor : public AudioProcessor {
+public:
+    CounterProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver), sampleCount(0) {};
+
+    void process() override {
+        auto &buffer = getBuffer();
+        for (size_t i = 0; i < getBufferSize(); i++) {
+            buffer.getWritePointer(0)[i] = static_cast<float>(sampleCount++) / 32767.0f;
+            buffer.getWritePointer(1)[i] = -2.0f;
+        }
+    }
+
+    size_t sampleCount;
+};
+
+static uint32_t readInteger(const std::vector<uint8_t> &data, size_t position, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= static_cast<uint32_t>(data[position + i]) << (8 * i);
+    }
+    return value;
+}
+
+TEST_CASE("OfflineAudioDriver", "[audio]") {
+    const char *path = "offline_audio_driver_test.wav";
+    const size_t blocks = 8;
+    OfflineAudioDriver driver(path, blocks);
+    CounterProcessor processor(driver);
+    REQUIRE(driver.init());
+    driver.setAudioProcessable(processor);
+    REQUIRE(driver.start());
+
+    // the last block rendered by the processor can exceed the driver buffers
+    REQUIRE(processor.sampleCount >= blocks * AUDIO_DRIVER_BUFFER_SIZE);
+    REQUIRE(processor.sampleCount < blocks * AUDIO_DRIVER_BUFFER_SIZE + AUDIO_PROCESSOR_BLOCK_SIZE);
+    REQUIRE(driver.getRenderedSeconds() == Approx(blocks * AUDIO_DRIVER_BUFFER_SIZE / 44100.0));
+    REQUIRE(driver.getRealtimeFactor() > 0.0);
+
+    std::FILE *file = std::fopen(path, "rb");
+    REQUIRE(file != nullptr);
+    std::vector<uint8_t> data;
+    int c;
+    while ((c = std::fgetc(file)) != EOF) data.push_back(static_cast<uint8_t>(c));
+    std::fclose(file);
+    std::remove(path);
+
+    const size_t dataSize = blocks * AUDIO_DRIVER_BUFFER_SIZE * 2 * sizeof(int16_t);
+    REQUIRE(data.size() == 44 + dataSize);
+
+    SECTION("header") {
+        REQUIRE(std::string(data.begin(), data.begin() + 4) == "RIFF");
+        REQUIRE(readInteger(data, 4, 4) == 36 + dataSize);
+        REQUIRE(std::string(data.begin() + 8, data.begin() + 16) == "WAVEfmt ");
+        REQUIRE(readInteger(data, 20, 2) == 1);
+        REQUIRE(readInteger(data, 22, 2) == 2);
+        REQUIRE(readInteger(data, 24, 4) == AUDIO_DRIVER_SAMPLE_RATE);
+        REQUIRE(readInteger(data, 34, 2) == 16);
+        REQUIRE(std::string(data.begin() + 36, data.begin() + 40) == "data");
+        REQUIRE(readInteger(data, 40, 4) == dataSize);
+    }
+
+    SECTION("samples") {
+        for (size_t i = 0; i < blocks * AUDIO_DRIVER_BUFFER_SIZE; i++) {
+            REQUIRE(readInteger(data, 44 + 4 * i, 2) == i);
+            // clipped to -1.0
+            REQUIRE(static_cast<int16_t>(readInteger(data, 44 + 4 * i + 2, 2)) == -32767);
+        }
+    }
+}
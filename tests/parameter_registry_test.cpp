@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include "../include/parameter_registry.h"
+#include <atomic>
+#include <thread>
+
+TEST_CASE("ParameterRegistry", "[audio]") {
+    ParameterRegistry<4> registry;
+    const auto gain = registry.add("gain", 1.0f, 10);
+    const auto cutoff = registry.add("cutoff", 1000.0f, 20);
+
+    SECTION("registration") {
+        REQUIRE(gain == 0);
+        REQUIRE(cutoff == 1);
+        REQUIRE(registry.size() == 2);
+        REQUIRE(registry.find("cutoff") == cutoff);
+        REQUIRE(registry.find("resonance") == ParameterRegistry<4>::invalidId);
+        REQUIRE(registry.getInterpolatedValue(cutoff) == 1000.0f);
+
+        registry.add("resonance", 0.0f);
+        registry.add("drive", 0.0f);
+        REQUIRE(registry.add("mix", 0.0f) == ParameterRegistry<4>::invalidId);
+    }
+
+    SECTION("snapshot publishing") {
+        registry.setValue(gain, 0.0f);
+        registry.update();
+        // nothing is published yet
+        REQUIRE(registry.getValue(gain) == 1.0f);
+
+        registry.publish();
+        registry.update();
+        REQUIRE(registry.getValue(gain) == 0.0f);
+        REQUIRE(registry.getValue(cutoff) == 1000.0f);
+        REQUIRE(registry.transitionIsComplete(cutoff));
+
+        // the ramps follow an AudioParameter with the same transition
+        AudioParameter<float> reference(1.0f);
+        reference.setTransitionSamples(10);
+        reference.setValue(0.0f);
+        float ramp[4];
+        float expected[4];
+        for (int block = 0; block < 4; block++) {
+            registry.fillRamp(gain, ramp, 4);
+            reference.fillRamp(expected, 4);
+            for (int i = 0; i < 4; i++) {
+                REQUIRE(ramp[i] == Approx(expected[i]).margin(1e-6));
+            }
+            registry.advance(4);
+        }
+        REQUIRE(registry.transitionIsComplete(gain));
+        REQUIRE(registry.getInterpolatedValue(gain) == 0.0f);
+
+        SECTION("new value during a transition") {
+            registry.setValue(cutoff, 2000.0f);
+            registry.publish();
+            registry.update();
+            registry.advance(5);
+            REQUIRE(registry.getInterpolatedValue(cutoff) == Approx(1250.0f));
+
+            registry.setValue(cutoff, 0.0f);
+            registry.publish();
+            registry.update();
+            REQUIRE(registry.getInterpolatedValue(cutoff) == Approx(1250.0f));
+            registry.advance(20);
+            REQUIRE(registry.getInterpolatedValue(cutoff) == 0.0f);
+        }
+    }
+
+    SECTION("presets published by another thread") {
+        const int presets = 2000;
+        std::atomic<bool> done(false);
+
+        std::thread control([&] {
+            ParameterRegistry<4>::Snapshot preset = registry.getSnapshot();
+            for (int i = 1; i <= presets; i++) {
+                // the two values of a preset are always consistent
+                preset[gain] = static_cast<float>(i);
+                preset[cutoff] = static_cast<float>(-i);
+                registry.setSnapshot(preset);
+                registry.publish();
+            }
+            done.store(true, std::memory_order_release);
+        });
+
+        bool finished = false;
+        while (!finished) {
+            finished = done.load(std::memory_order_acquire);
+            registry.update();
+            const float g = registry.getValue(gain);
+            const float c = registry.getValue(cutoff);
+            if (g != 1.0f) {
+                REQUIRE(c == -g);
+            }
+            registry.advance(8);
+        }
+        control.join();
+
+        registry.update();
+        REQUIRE(registry.getValue(gain) == static_cast<float>(presets));
+        REQUIRE(registry.getValue(cutoff) == static_cast<float>(-presets));
+    }
+}
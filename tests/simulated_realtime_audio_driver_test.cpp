@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "../include/simulated_realtime_audio_driver.h"
+#include "../include/audio_processor.h"
+#include <chrono>
+#include <thread>
+
+/**
+ * Processor that overruns its deadline on some callbacks,
+ * and stops the driver after a certain number of callbacks.
+ */
+class SlowProcessor : public AudioProcessor {
+public:
+    SlowProcessor(SimulatedRealtimeAudioDriver &audioDriver, size_t slowEvery, size_t stopAfter)
+            : AudioProcessor(audioDriver), driver(audioDriver), slowEvery(slowEvery),
+              stopAfter(stopAfter), callbacks(0) {};
+
+    void process() override {
+        callbacks++;
+        if (slowEvery > 0 && callbacks % slowEvery == 0) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(2.5 * driver.getStats().deadline));
+        }
+        if (callbacks == stopAfter) driver.stop();
+    }
+
+    SimulatedRealtimeAudioDriver &driver;
+    size_t slowEvery;
+    size_t stopAfter;
+    size_t callbacks;
+};
+
+/**
+ * Number of processor calls needed to fill a number of driver callbacks.
+ */
+static size_t processorCalls(size_t driverCallbacks) {
+    return (driverCallbacks * AUDIO_DRIVER_BUFFER_SIZE + AUDIO_PROCESSOR_BLOCK_SIZE - 1) / AUDIO_PROCESSOR_BLOCK_SIZE;
+}
+
+/**
+ * Driver callback that makes the processor call of the given index, starting from 1.
+ */
+static size_t driverCallback(size_t processorCall) {
+    return (processorCall - 1) * AUDIO_PROCESSOR_BLOCK_SIZE / AUDIO_DRIVER_BUFFER_SIZE + 1;
+}
+
+TEST_CASE("SimulatedRealtimeAudioDriver", "[audio]") {
+    const double deadline = AUDIO_DRIVER_BUFFER_SIZE / static_cast<double>(AUDIO_DRIVER_SAMPLE_RATE);
+
+    SECTION("pacing") {
+        SimulatedRealtimeAudioDriver driver(10);
+        SlowProcessor processor(driver, 0, 0);
+        driver.init();
+        driver.setAudioProcessable(processor);
+
+        const auto begin = std::chrono::steady_clock::now();
+        driver.start();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        const AudioDriverStats &stats = driver.getStats();
+        REQUIRE(processor.callbacks == processorCalls(10));
+        REQUIRE(stats.callbacks == 10);
+        REQUIRE(stats.deadline == Approx(deadline));
+        // the first callback starts immediately, the others are paced
+        REQUIRE(elapsed >= 9 * deadline * 0.99);
+        REQUIRE(stats.getLoad() < 1.0);
+    }
+
+    SECTION("xruns") {
+        // a slow processor call about every 4 driver callbacks
+        const size_t slowEvery = 4 * AUDIO_DRIVER_BUFFER_SIZE / AUDIO_PROCESSOR_BLOCK_SIZE;
+        SimulatedRealtimeAudioDriver driver(12);
+        SlowProcessor processor(driver, (slowEvery > 0) ? slowEvery : 1, 0);
+        driver.init();
+        driver.setAudioProcessable(processor);
+        driver.start();
+
+        const AudioDriverStats &stats = driver.getStats();
+        REQUIRE(stats.callbacks == 12);
+        REQUIRE(stats.xruns >= 3);
+        REQUIRE(stats.maxExecutionTime >= 2.5 * deadline);
+        REQUIRE(stats.getAverageExecutionTime() <= stats.maxExecutionTime);
+    }
+
+    SECTION("stop") {
+        SimulatedRealtimeAudioDriver driver;
+        SlowProcessor processor(driver, 0, 5);
+        driver.init();
+        driver.setAudioProcessable(processor);
+        driver.start();
+        REQUIRE(driver.getStats().callbacks == driverCallback(5));
+    }
+}
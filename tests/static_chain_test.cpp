@@ -0,0 +1,147 @@
+#include "catch.hpp"
+#include "../include/static_chain.h"
+#include "../include/audio_processor.h"
+
+namespace {
+    class StaticChainTestProcessor : public AudioProcessor {
+    public:
+        explicit StaticChainTestProcessor(AudioDriver &audioDriver) : AudioProcessor(audioDriver) {};
+
+        void process() override {};
+    };
+
+    /**
+     * Adds a constant to its input and multiplies the result by a gain.
+     */
+    class StaticAffineModule : public AudioModule<2> {
+    public:
+        StaticAffineModule(AudioProcessor &audioProcessor, float offset, float gain)
+                : AudioModule<2>(audioProcessor), offset(offset), gain(gain), calls(0) {};
+
+        void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+            calls++;
+            for (size_t c = 0; c < 2; c++) {
+                float *samples = buffer.getWritePointer(c);
+                for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                    samples[i] = (samples[i] + offset) * gain;
+                }
+            }
+        }
+
+        float offset;
+        float gain;
+        int calls;
+    };
+
+    /**
+     * Derived module overriding the process, to check that the chain calls the concrete type.
+     */
+    class StaticNegatedModule final : public StaticAffineModule {
+    public:
+        explicit StaticNegatedModule(AudioProcessor &audioProcessor) : StaticAffineModule(audioProcessor, 0.0f, 1.0f) {};
+
+        void process(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer) override {
+            calls++;
+            buffer.applyGain(-1.0f);
+        }
+    };
+
+    void fill(AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer, float value) {
+        for (size_t c = 0; c < 2; c++) {
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) buffer.getWritePointer(c)[i] = value;
+        }
+    }
+
+    bool allEqual(const AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> &buffer, float value) {
+        for (size_t c = 0; c < 2; c++) {
+            for (size_t i = 0; i < AUDIO_PROCESSOR_BLOCK_SIZE; i++) {
+                if (buffer.getReadPointer(c)[i] != value) return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE("StaticChain", "[audio]") {
+    AudioDriver driver;
+    StaticChainTestProcessor processor(driver);
+    AudioBuffer<float, 2, AUDIO_PROCESSOR_BLOCK_SIZE> buffer;
+
+    SECTION("chain") {
+        StaticAffineModule offset(processor, 1.0f, 1.0f);
+        StaticAffineModule gain(processor, 0.0f, 3.0f);
+        StaticNegatedModule negated(processor);
+        StaticChain<StaticAffineModule, StaticAffineModule, StaticNegatedModule> chain(offset, gain, negated);
+        REQUIRE(decltype(chain)::channelNumber == 2);
+        REQUIRE(&chain.get<1>() == &gain);
+
+        fill(buffer, 1.0f);
+        chain.process(buffer);
+        // modules processed in order: ((1 + 1) * 3) * -1
+        REQUIRE(allEqual(buffer, -6.0f));
+        REQUIRE(offset.calls == 1);
+        REQUIRE(gain.calls == 1);
+        REQUIRE(negated.calls == 1);
+
+        // the modules are referenced, changes are seen by the chain
+        gain.gain = 2.0f;
+        fill(buffer, 0.0f);
+        chain.process(buffer);
+        REQUIRE(allEqual(buffer, -2.0f));
+    }
+
+    SECTION("derived module bound to a base type") {
+        StaticNegatedModule negated(processor);
+        StaticChain<StaticAffineModule> chain(negated);
+        StaticChain<AudioModule<2>> base(negated);
+
+        // the types can be overridden, the process of the object is called as a virtual one
+        fill(buffer, 2.0f);
+        chain.process(buffer);
+        REQUIRE(allEqual(buffer, -2.0f));
+        base.process(buffer);
+        REQUIRE(allEqual(buffer, 2.0f));
+        REQUIRE(negated.calls == 2);
+    }
+
+    SECTION("mix") {
+        StaticAffineModule first(processor, 1.0f, 1.0f);
+        StaticAffineModule second(processor, 0.0f, 10.0f);
+        StaticNegatedModule third(processor);
+        StaticMix<StaticAffineModule, StaticAffineModule, StaticNegatedModule> mix(first, second, third);
+
+        fill(buffer, 2.0f);
+        mix.process(buffer);
+        // every module sees the same input: (2 + 1) + 2 * 10 - 2
+        REQUIRE(allEqual(buffer, 21.0f));
+        REQUIRE(first.calls == 1);
+        REQUIRE(third.calls == 1);
+    }
+
+    SECTION("single module mix") {
+        StaticAffineModule gain(processor, 0.0f, 4.0f);
+        StaticMix<StaticAffineModule> mix(gain);
+
+        fill(buffer, 2.0f);
+        mix.process(buffer);
+        REQUIRE(allEqual(buffer, 8.0f));
+    }
+
+    SECTION("nested") {
+        StaticAffineModule source(processor, 1.0f, 1.0f);
+        StaticAffineModule dry(processor, 0.0f, 1.0f);
+        StaticAffineModule wet(processor, 0.0f, 0.5f);
+        StaticNegatedModule negated(processor);
+        typedef StaticChain<StaticAffineModule, StaticNegatedModule> WetChain;
+        typedef StaticMix<StaticAffineModule, WetChain> DryWetMix;
+        WetChain wetChain(wet, negated);
+        DryWetMix dryWet(dry, wetChain);
+        StaticChain<StaticAffineModule, DryWetMix> chain(source, dryWet);
+        REQUIRE(decltype(chain)::channelNumber == 2);
+
+        fill(buffer, 3.0f);
+        chain.process(buffer);
+        // x = 3 + 1, then x - 0.5 * x
+        REQUIRE(allEqual(buffer, 2.0f));
+    }
+}
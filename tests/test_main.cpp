@@ -1,11 +1,28 @@
 #define CATCH_CONFIG_MAIN
 #define CATCH_CONFIG_FAST_COMPILE
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
+#include "../include/audio_block_adapter.h"
 #include "../include/audio_buffer.h"
+#include "../include/audio_buffer_expression.h"
 #include "../include/audio_config.h"
+#include "../include/audio_graph.h"
+#include "../include/audio_graph_scheduler.h"
+#include "../include/audio_load_meter.h"
 #include "../include/audio_math.h"
 #include "../include/audio_module.h"
 #include "../include/audio_parameter.h"
+#include "../include/audio_pcm.h"
 #include "../include/audio_processable.h"
 #include "../include/audio_processor.h"
-#include "../include/circular_buffer.h"
\ No newline at end of file
+#include "../include/audio_profiler.h"
+#include "../include/audio_simd.h"
+#include "../include/circular_buffer.h"
+#include "../include/delay_line.h"
+#include "../include/dma_double_buffer.h"
+#include "../include/double_buffered_audio_driver.h"
+#include "../include/offline_audio_driver.h"
+#include "../include/parameter_registry.h"
+#include "../include/simulated_dma_audio_driver.h"
+#include "../include/simulated_realtime_audio_driver.h"
+#include "../include/static_chain.h"
\ No newline at end of file